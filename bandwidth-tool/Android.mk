@@ -12,4 +12,26 @@ LOCAL_MODULE_TAGS := optional
 LOCAL_FORCE_STATIC_EXECUTABLE := true
 include $(BUILD_EXECUTABLE)
 
+####### memtraffic  ######################################
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES:= memtraffic.c \
+		  traffic.c
+
+LOCAL_MODULE := memtraffic
+LOCAL_CFLAGS := -O2
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+####### latprobe  ########################################
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES:= latprobe.c \
+		  traffic.c
+
+LOCAL_MODULE := latprobe
+LOCAL_CFLAGS := -O2
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
 ###########################################################
@@ -23,6 +23,7 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <signal.h>
 #include "statcoll.h"
 
 #define PAGE_SIZE 4096
@@ -68,10 +69,21 @@ static int DELAY = 1;
 static int EMIF_PERF_CFG1 = 9;
 static int EMIF_PERF_CFG2 = 10;
 
+/* DDR configuration used by the efficiency model.
+   DRA74x: 2 x 32-bit EMIFs, DRA72x: 1 x 32-bit EMIF */
+static int EMIF_EFFICIENCY = 0;
+static int DDR_WIDTH = 32;      /* data bus width per EMIF, in bits */
+static int DDR_RATE = 1066;     /* data rate, in MT/s */
+static int NUM_EMIF = 2;
+
 
 static int STATCOLL=0;
 static int TOTAL_TIME;
 static int INTERVAL_US;
+static int DISCOVERY = 0;
+static int DISCOVERY_TIME = 2;
+static int DISCOVERY_WINDOW_US = 250000;
+static int TOP_N = 8;
 
 struct timeval t1, t2;
 
@@ -100,6 +112,11 @@ static void *emif_init(int fd, unsigned base)
     return mem;
 }
 
+static void emif_config(volatile uint32_t *emif, int cfg1, int cfg2)
+{
+    emif[EMIF_PERF_CNT_CFG>>2] = cfg2 << 16 | cfg1;
+}
+
 static void emif_read(volatile uint32_t *emif, struct emif_stats *st)
 {
     st->cycles = emif[EMIF_PERF_CNT_TIM>>2];
@@ -177,6 +194,208 @@ static void perf_close(void)
     if (emif2) munmap(emif2, PAGE_SIZE);
 }
 
+/*
+ * DDR efficiency model
+ *
+ * Only two of the EMIF performance counters can be observed at a time, so
+ * every DELAY interval is split in two halves: the first half counts
+ * access/activate, the second half counts cmd_pend/data. Each half carries
+ * its own cycle count, so the ratios stay exact.
+ *
+ *   peak       = DDR_RATE * DDR_WIDTH / 8                 (per EMIF)
+ *   data util  = data cycles / total cycles
+ *   achieved   = data util * peak
+ *   row hit    = 1 - activate / access
+ *   cmd queue  = cmd_pend cycles / total cycles
+ *
+ * An EMIF whose data bus is busy most of the time is bandwidth-bound. An
+ * EMIF with a long command queue but an idle data bus is efficiency-bound:
+ * the traffic pattern (row misses, read/write turnarounds) is the problem,
+ * not the amount of traffic.
+ */
+#define EFF_BW_BOUND_PCT    70
+#define EFF_CMD_PRESSURE_PCT 50
+
+enum eff_verdict {
+    EFF_HEADROOM = 0,
+    EFF_BW_BOUND,
+    EFF_EFFICIENCY_BOUND,
+    EFF_NUM_VERDICTS
+};
+
+static const char *eff_verdict_name[EFF_NUM_VERDICTS] = {
+    "headroom",
+    "bandwidth-bound",
+    "efficiency-bound",
+};
+
+struct emif_eff {
+    double data_util;
+    double achieved_mbps;
+    double row_hit;
+    double cmd_pressure;
+    enum eff_verdict verdict;
+};
+
+struct emif_eff_summary {
+    unsigned samples;
+    double data_util;
+    double achieved_mbps;
+    double peak_mbps;
+    double row_hit;
+    double cmd_pressure;
+    unsigned verdicts[EFF_NUM_VERDICTS];
+};
+
+static struct emif_eff_summary eff_summary[2];
+static volatile sig_atomic_t eff_stop;
+
+static void eff_sigint(int sig)
+{
+    eff_stop = 1;
+}
+
+static double eff_peak_mbps(void)
+{
+    return (double)DDR_RATE * DDR_WIDTH / 8;
+}
+
+static void eff_compute(struct emif_stats *acc1, struct emif_stats *acc2,
+                        struct emif_stats *dat1, struct emif_stats *dat2,
+                        struct emif_eff *eff)
+{
+    uint32_t acc_cycles = acc2->cycles - acc1->cycles;
+    uint32_t access     = acc2->cnt1   - acc1->cnt1;
+    uint32_t activate   = acc2->cnt2   - acc1->cnt2;
+    uint32_t dat_cycles = dat2->cycles - dat1->cycles;
+    uint32_t cmd_pend   = dat2->cnt1   - dat1->cnt1;
+    uint32_t data       = dat2->cnt2   - dat1->cnt2;
+
+    memset(eff, 0, sizeof(*eff));
+
+    if (dat_cycles) {
+        eff->data_util = (double)data / dat_cycles;
+        eff->cmd_pressure = (double)cmd_pend / dat_cycles;
+    }
+    eff->achieved_mbps = eff->data_util * eff_peak_mbps();
+
+    if (acc_cycles && access)
+        eff->row_hit = activate >= access ?
+                       0.0 : 1.0 - (double)activate / access;
+
+    if (eff->data_util * 100 >= EFF_BW_BOUND_PCT)
+        eff->verdict = EFF_BW_BOUND;
+    else if (eff->cmd_pressure * 100 >= EFF_CMD_PRESSURE_PCT)
+        eff->verdict = EFF_EFFICIENCY_BOUND;
+    else
+        eff->verdict = EFF_HEADROOM;
+}
+
+static void eff_accumulate(struct emif_eff_summary *sum, struct emif_eff *eff)
+{
+    sum->samples++;
+    sum->data_util += eff->data_util;
+    sum->achieved_mbps += eff->achieved_mbps;
+    sum->row_hit += eff->row_hit;
+    sum->cmd_pressure += eff->cmd_pressure;
+    sum->verdicts[eff->verdict]++;
+    if (eff->achieved_mbps > sum->peak_mbps)
+        sum->peak_mbps = eff->achieved_mbps;
+}
+
+static void eff_print(const char *tag, struct emif_eff *eff)
+{
+    printf("%s %5.0f MB/s data %2.0f%% rowhit %2.0f%% cmdq %2.0f%% %-16s",
+           tag, eff->achieved_mbps, 100 * eff->data_util,
+           100 * eff->row_hit, 100 * eff->cmd_pressure,
+           eff_verdict_name[eff->verdict]);
+    fprintf(outfile, "%sachieved_mbps= %.0f,%sdata_util= %.1f,"
+            "%srow_hit= %.1f,%scmd_pressure= %.1f,%sverdict= %s,",
+            tag, eff->achieved_mbps, tag, 100 * eff->data_util,
+            tag, 100 * eff->row_hit, tag, 100 * eff->cmd_pressure,
+            tag, eff_verdict_name[eff->verdict]);
+}
+
+static void eff_report(void)
+{
+    int i, v, best;
+    double total = 0, peak = eff_peak_mbps();
+
+    printf("\n\n-------------------------------------------------------------------\n");
+    printf(" DDR efficiency summary: %d EMIF x %d bit @ %d MT/s\n",
+           NUM_EMIF, DDR_WIDTH, DDR_RATE);
+    printf(" Theoretical peak: %.0f MB/s per EMIF, %.0f MB/s total\n",
+           peak, peak * NUM_EMIF);
+    printf("-------------------------------------------------------------------\n");
+    printf(" EMIF   Average   Peak(MB/s)  Data   RowHit  CmdQ   Verdict\n");
+
+    for (i = 0; i < NUM_EMIF; i++) {
+        struct emif_eff_summary *sum = &eff_summary[i];
+
+        if (!sum->samples)
+            continue;
+
+        best = 0;
+        for (v = 1; v < EFF_NUM_VERDICTS; v++)
+            if (sum->verdicts[v] > sum->verdicts[best])
+                best = v;
+
+        total += sum->achieved_mbps / sum->samples;
+        printf(" EMIF%d %8.0f %10.0f %6.1f%% %6.1f%% %5.1f%%  %s (%u/%u samples)\n",
+               i + 1, sum->achieved_mbps / sum->samples, sum->peak_mbps,
+               100 * sum->data_util / sum->samples,
+               100 * sum->row_hit / sum->samples,
+               100 * sum->cmd_pressure / sum->samples,
+               eff_verdict_name[best], sum->verdicts[best], sum->samples);
+    }
+
+    printf("-------------------------------------------------------------------\n");
+    printf(" Total achieved: %.0f MB/s (%.1f%% of theoretical peak)\n",
+           total, peak ? 100 * total / (peak * NUM_EMIF) : 0);
+    printf("-------------------------------------------------------------------\n");
+}
+
+static void eff_run(void)
+{
+    struct emif_stats acc_start[2], acc_end[2], dat_start[2], dat_end[2];
+    volatile uint32_t *emif[2] = { emif1, emif2 };
+    struct emif_eff eff;
+    unsigned half_us = DELAY * 500000;
+    int i;
+
+    signal(SIGINT, eff_sigint);
+
+    while (!eff_stop) {
+        for (i = 0; i < NUM_EMIF; i++) {
+            emif_config(emif[i], 0, 1);   /* access, activate */
+            emif_read(emif[i], &acc_start[i]);
+        }
+        usleep(half_us);
+        for (i = 0; i < NUM_EMIF; i++) {
+            emif_read(emif[i], &acc_end[i]);
+            emif_config(emif[i], 9, 10);  /* cmd_pend, data */
+            emif_read(emif[i], &dat_start[i]);
+        }
+        usleep(half_us);
+        for (i = 0; i < NUM_EMIF; i++)
+            emif_read(emif[i], &dat_end[i]);
+
+        for (i = 0; i < NUM_EMIF; i++) {
+            eff_compute(&acc_start[i], &acc_end[i],
+                        &dat_start[i], &dat_end[i], &eff);
+            eff_accumulate(&eff_summary[i], &eff);
+            eff_print(i ? "EMIF2" : "EMIF1", &eff);
+            printf("\t");
+        }
+        printf("\r");
+        fprintf(outfile, "\n");
+        fflush(outfile);
+        fflush(stdout);
+    }
+
+    eff_report();
+}
+
 static int get_cfg(const char *name, int def)
 {
     char *end;
@@ -245,6 +464,14 @@ char keylist[][50] = {
 	"TOTAL_TIME",
 	"INTERVAL_US",
 	"INITIATORS",
+	"EMIF_EFFICIENCY",
+	"DDR_WIDTH",
+	"DDR_RATE",
+	"NUM_EMIF",
+	"DISCOVERY",
+	"DISCOVERY_TIME",
+	"DISCOVERY_WINDOW_US",
+	"TOP_N",
 };
 
 char line[512], *p;
@@ -298,6 +525,14 @@ void add_key_value(char *key, int value)
 			EMIF_PERF_CFG1 = value;
 		else if(strcmp(key, "EMIF_PERF_CFG2") == 0)
 			EMIF_PERF_CFG2 = value;
+		else if(strcmp(key, "EMIF_EFFICIENCY") == 0)
+			EMIF_EFFICIENCY = value;
+		else if(strcmp(key, "DDR_WIDTH") == 0)
+			DDR_WIDTH = value;
+		else if(strcmp(key, "DDR_RATE") == 0)
+			DDR_RATE = value;
+		else if(strcmp(key, "NUM_EMIF") == 0)
+			NUM_EMIF = value;
 	}
 	else
 		printf("NOTE: BANDWIDTH is not enabled, ignoring %s\n", key);
@@ -308,6 +543,14 @@ void add_key_value(char *key, int value)
 			INTERVAL_US = value;
 		else if(strcmp(key, "TOTAL_TIME") == 0)
 			TOTAL_TIME = value;
+		else if(strcmp(key, "DISCOVERY") == 0)
+			DISCOVERY = value;
+		else if(strcmp(key, "DISCOVERY_TIME") == 0)
+			DISCOVERY_TIME = value;
+		else if(strcmp(key, "DISCOVERY_WINDOW_US") == 0)
+			DISCOVERY_WINDOW_US = value;
+		else if(strcmp(key, "TOP_N") == 0)
+			TOP_N = value;
         }
 	else
 		printf("NOTE: STATCOLL is not enabled, ignoring %s\n", key);
@@ -331,6 +574,9 @@ void bandwidth_usage() {
            "##             8  -> prio,\n"
            "##             9  -> cmd_pend,\n"
            "##             10 -> data    \n##\n"
+           "##  EMIF_EFFICIENCY=1 : ignore EMIF_PERF_CFG1/2 and report DDR\n"
+           "##             efficiency using DDR_WIDTH (bits), DDR_RATE (MT/s)\n"
+           "##             and NUM_EMIF (2 on DRA74x, 1 on DRA72x)\n##\n"
 
            "##  EMIF frq : %d MHz\n\n", emif_freq() );
 }
@@ -340,6 +586,9 @@ void print_usage()
 {
      printf("USAGE: glsdkstatcoll -f config.ini\n"
              "\n There should be another file called initiators.cfg that should be present in the same directory\n"
+             "\n With DISCOVERY=1 initiators.cfg is not needed: all initiators are scanned for DISCOVERY_TIME"
+             "\n seconds and the rest of TOTAL_TIME is captured on the EMIF totals and the TOP_N busiest ones,"
+             "\n the ranking is written to statcoll-discovery.csv\n"
              "\n LIST OF INITIATORS \n"
              "\n STATCOL_EMIF1_SYS"
              "\n STATCOL_EMIF2_SYS"
@@ -526,6 +775,20 @@ int main(int argc, char **argv)
 		    return 1;
 	    }
 
+	    if (EMIF_EFFICIENCY == 1) {
+		    if (NUM_EMIF < 1 || NUM_EMIF > 2)
+			    NUM_EMIF = 2;
+		    outfile = fopen("emif-efficiency.csv", "w+");
+		    if (!outfile) {
+			    printf("\n Error opening file");
+			    return 1;
+		    }
+		    eff_run();
+		    fclose(outfile);
+		    perf_close();
+		    return 0;
+	    }
+
 	    outfile = fopen("emif-performance.csv", "w+");
 	    if (!outfile) {
 		    printf("\n Error opening file");
@@ -545,6 +808,11 @@ int main(int argc, char **argv)
     if(STATCOLL == 1) {
 	    printf("STATISTICS COLLECTOR option chosen\n");
             printf("------------------------------------------------\n\n");
+
+	    if(DISCOVERY == 1)
+		    return statcoll_discover(TOTAL_TIME, INTERVAL_US, DISCOVERY_TIME,
+					     DISCOVERY_WINDOW_US, TOP_N);
+
 #ifdef ANDROID
 	    fp = fopen("/data/statcoll/initiators.cfg", "r");
 #else
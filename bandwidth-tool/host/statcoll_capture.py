@@ -0,0 +1,182 @@
+# Helpers to load and summarise captures written by glsdkstatcoll
+#
+# Every capture is a CSV with one sample per line and "NAME= value," pairs:
+#   statcollector.csv     STATCOL_* bytes per INTERVAL_US sample
+#   emif-performance.csv  EMIFn<counter> percentage per DELAY sample
+#   emif-efficiency.csv   EMIFn<metric> per DELAY sample
+#
+# License: BSD
+#
+
+from __future__ import print_function, division
+
+import math
+
+
+class Capture(object):
+        def __init__(self, path):
+                self.path = path
+                self.names = []
+                self.series = {}
+                self.samples = 0
+
+        def column(self, name):
+                return self.series.get(name, [])
+
+        def statcoll_names(self):
+                return [n for n in self.names if n.startswith('STATCOL_')]
+
+        def total(self, names=None):
+                """Per-sample sum over the given (default: all) columns"""
+                if names is None:
+                        names = self.names
+                cols = [self.series[n] for n in names if n in self.series]
+                return [sum(vals) for vals in zip(*cols)] if cols else []
+
+        def slice(self, start, length):
+                cap = Capture(self.path)
+                cap.names = list(self.names)
+                for name in self.names:
+                        cap.series[name] = self.series[name][start:start + length]
+                cap.samples = len(cap.series[self.names[0]]) if self.names else 0
+                return cap
+
+
+def load(path, interval_us=None):
+        """Read a capture. With interval_us, STATCOL_* columns are converted
+        from bytes per sample to MB/s."""
+        cap = Capture(path)
+        ifile = open(path, 'r')
+        for line in ifile:
+                row = {}
+                for item in line.strip().split(','):
+                        if '=' not in item:
+                                continue
+                        name, value = item.split('=', 1)
+                        name = name.strip()
+                        try:
+                                row[name] = float(value)
+                        except ValueError:
+                                continue
+                if not row:
+                        continue
+                for name in row:
+                        if name not in cap.series:
+                                cap.names.append(name)
+                                cap.series[name] = [0.0] * cap.samples
+                for name in cap.names:
+                        cap.series[name].append(row.get(name, 0.0))
+                cap.samples += 1
+        ifile.close()
+
+        if interval_us:
+                for name in cap.statcoll_names():
+                        cap.series[name] = [v / interval_us for v in cap.series[name]]
+        return cap
+
+
+def mean(values):
+        return sum(values) / len(values) if values else 0.0
+
+
+def variance(values):
+        if len(values) < 2:
+                return 0.0
+        m = mean(values)
+        return sum((v - m) ** 2 for v in values) / (len(values) - 1)
+
+
+def percentile(values, pct):
+        if not values:
+                return 0.0
+        ordered = sorted(values)
+        idx = int(round(pct / 100.0 * (len(ordered) - 1)))
+        return ordered[min(idx, len(ordered) - 1)]
+
+
+def block_means(values, block):
+        """Average consecutive samples so that neighbouring values are closer
+        to independent before testing them"""
+        if block <= 1:
+                return list(values)
+        return [mean(values[i:i + block])
+                for i in range(0, len(values) - block + 1, block)]
+
+
+def pearson(xs, ys):
+        n = min(len(xs), len(ys))
+        if n < 2:
+                return 0.0
+        mx, my = mean(xs[:n]), mean(ys[:n])
+        sxy = sum((xs[i] - mx) * (ys[i] - my) for i in range(n))
+        sxx = sum((xs[i] - mx) ** 2 for i in range(n))
+        syy = sum((ys[i] - my) ** 2 for i in range(n))
+        if sxx == 0 or syy == 0:
+                return 0.0
+        return sxy / math.sqrt(sxx * syy)
+
+
+def lagged_pearson(xs, ys, lag):
+        """Correlation of xs[t] with ys[t + lag]"""
+        if lag >= 0:
+                return pearson(xs[:len(xs) - lag], ys[lag:])
+        return pearson(xs[-lag:], ys[:len(ys) + lag])
+
+
+def _betacf(a, b, x):
+        # continued fraction for the incomplete beta function
+        qab, qap, qam = a + b, a + 1.0, a - 1.0
+        c, d = 1.0, 1.0 - qab * x / qap
+        if abs(d) < 1e-30:
+                d = 1e-30
+        d = 1.0 / d
+        h = d
+        for m in range(1, 201):
+                m2 = 2 * m
+                aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+                d = 1.0 + aa * d
+                if abs(d) < 1e-30:
+                        d = 1e-30
+                c = 1.0 + aa / c
+                if abs(c) < 1e-30:
+                        c = 1e-30
+                d = 1.0 / d
+                h *= d * c
+                aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+                d = 1.0 + aa * d
+                if abs(d) < 1e-30:
+                        d = 1e-30
+                c = 1.0 + aa / c
+                if abs(c) < 1e-30:
+                        c = 1e-30
+                d = 1.0 / d
+                delta = d * c
+                h *= delta
+                if abs(delta - 1.0) < 3e-12:
+                        break
+        return h
+
+
+def _betai(a, b, x):
+        if x <= 0.0:
+                return 0.0
+        if x >= 1.0:
+                return 1.0
+        bt = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) +
+                      a * math.log(x) + b * math.log(1.0 - x))
+        if x < (a + 1.0) / (a + b + 2.0):
+                return bt * _betacf(a, b, x) / a
+        return 1.0 - bt * _betacf(b, a, 1.0 - x) / b
+
+
+def welch_test(xs, ys):
+        """Welch's t-test. Returns (t, two-sided p-value)."""
+        nx, ny = len(xs), len(ys)
+        if nx < 2 or ny < 2:
+                return 0.0, 1.0
+        vx, vy = variance(xs) / nx, variance(ys) / ny
+        if vx + vy == 0:
+                return 0.0, 1.0 if mean(xs) == mean(ys) else 0.0
+        t = (mean(ys) - mean(xs)) / math.sqrt(vx + vy)
+        df = (vx + vy) ** 2 / ((vx ** 2) / (nx - 1) + (vy ** 2) / (ny - 1))
+        return t, _betai(df / 2.0, 0.5, df / (df + t * t))
@@ -0,0 +1,228 @@
+# Compare two glsdkstatcoll captures and gate on bandwidth budgets
+#
+# Usage: python statcoll_compare.py [options] baseline.csv candidate.csv
+#
+# The two captures are aligned first, either on the first sample where a
+# marker column becomes active (--marker STATCOL_VIP1_P1), on the onset of
+# the total traffic (--align onset), on the lag that best correlates the
+# two total traffic curves (--align xcorr), or on explicit sample offsets
+# (--offset-a/--offset-b).
+#
+# For every column the mean, peak and percentiles of both captures are
+# printed with the change in mean and a Welch's t-test p-value over block
+# averages. The exit status is non-zero when a budget from --budget is
+# exceeded by the candidate, or when a column regresses significantly by
+# more than max_increase_pct.
+#
+# Budget file:
+#   [budget]
+#   STATCOL_DSS = 900            ; mean, MB/s
+#   STATCOL_GPU_P1.peak = 2500
+#   STATCOL_EMIF1_SYS.p99 = 3000
+#
+#   [regression]
+#   max_increase_pct = 10
+#   alpha = 0.01
+#
+# License: BSD
+#
+
+from __future__ import print_function, division
+
+import sys
+import optparse
+
+try:
+        import ConfigParser as configparser
+except ImportError:
+        import configparser
+
+import statcoll_capture as sc
+
+METRICS = ('mean', 'peak', 'p50', 'p95', 'p99')
+
+
+def summarise(values):
+        return {
+                'mean': sc.mean(values),
+                'peak': max(values) if values else 0.0,
+                'p50': sc.percentile(values, 50),
+                'p95': sc.percentile(values, 95),
+                'p99': sc.percentile(values, 99),
+        }
+
+
+def onset(values, fraction):
+        if not values:
+                return 0
+        threshold = fraction * max(values)
+        for i, v in enumerate(values):
+                if v > 0 and v >= threshold:
+                        return i
+        return 0
+
+
+def first_active(values):
+        for i, v in enumerate(values):
+                if v > 0:
+                        return i
+        return None
+
+
+def best_lag(xs, ys, max_lag):
+        best, best_r = 0, -2.0
+        for lag in range(-max_lag, max_lag + 1):
+                r = sc.lagged_pearson(xs, ys, lag)
+                if r > best_r:
+                        best, best_r = lag, r
+        return best, best_r
+
+
+def align(a, b, opts):
+        """Returns the start sample in each capture"""
+        if opts.offset_a is not None or opts.offset_b is not None:
+                return opts.offset_a or 0, opts.offset_b or 0
+
+        if opts.marker:
+                sa = first_active(a.column(opts.marker))
+                sb = first_active(b.column(opts.marker))
+                if sa is None or sb is None:
+                        print("ERROR: marker %s is never active in both captures" %
+                              opts.marker)
+                        sys.exit(2)
+                return sa, sb
+
+        if opts.align == 'onset':
+                return (onset(a.total(), opts.onset_fraction),
+                        onset(b.total(), opts.onset_fraction))
+
+        if opts.align == 'xcorr':
+                lag, r = best_lag(a.total(), b.total(), opts.max_lag)
+                print("Best lag %d samples (r = %.2f)" % (lag, r))
+                return (0, lag) if lag >= 0 else (-lag, 0)
+
+        return 0, 0
+
+
+def load_budget(path):
+        budget, regression = {}, {'max_increase_pct': None, 'alpha': 0.01}
+        if not path:
+                return budget, regression
+
+        config = configparser.ConfigParser()
+        config.optionxform = str
+        if not config.read(path):
+                print("ERROR: couldn't read budget file %s" % path)
+                sys.exit(2)
+
+        if config.has_section('budget'):
+                for key, value in config.items('budget'):
+                        name, metric = key, 'mean'
+                        if '.' in key:
+                                name, metric = key.rsplit('.', 1)
+                        if metric not in METRICS:
+                                print("ERROR: unknown metric %s in budget" % key)
+                                sys.exit(2)
+                        budget[(name, metric)] = float(value.split(';')[0])
+
+        if config.has_section('regression'):
+                for key, value in config.items('regression'):
+                        regression[key] = float(value.split(';')[0])
+
+        return budget, regression
+
+
+def main():
+        parser = optparse.OptionParser(
+                usage="%prog [options] baseline.csv candidate.csv")
+        parser.add_option("-i", "--interval-us", type="int", default=30000,
+                          help="INTERVAL_US of the statcoll captures [%default]")
+        parser.add_option("-a", "--align", type="choice",
+                          choices=('start', 'onset', 'xcorr'), default='start', help="start, onset or xcorr [%default]")
+        parser.add_option("-m", "--marker",
+                          help="align on the first active sample of this column")
+        parser.add_option("--offset-a", type="int", help="start sample in baseline")
+        parser.add_option("--offset-b", type="int", help="start sample in candidate")
+        parser.add_option("--onset-fraction", type="float", default=0.2,
+                          help="onset threshold as a fraction of peak [%default]")
+        parser.add_option("--max-lag", type="int", default=100,
+                          help="largest lag tried by xcorr, in samples [%default]")
+        parser.add_option("-n", "--length", type="int",
+                          help="samples to compare after alignment [shortest]")
+        parser.add_option("-k", "--block", type="int", default=10,
+                          help="samples per block for the t-test [%default]")
+        parser.add_option("-b", "--budget", help="budget/regression ini file")
+        opts, args = parser.parse_args()
+
+        if len(args) != 2:
+                parser.print_help()
+                sys.exit(2)
+
+        a = sc.load(args[0], opts.interval_us)
+        b = sc.load(args[1], opts.interval_us)
+        if not a.samples or not b.samples:
+                print("ERROR: empty capture")
+                sys.exit(2)
+
+        sa, sb = align(a, b, opts)
+        length = min(a.samples - sa, b.samples - sb)
+        if opts.length:
+                length = min(length, opts.length)
+        if length <= 0:
+                print("ERROR: nothing left to compare after alignment")
+                sys.exit(2)
+        a, b = a.slice(sa, length), b.slice(sb, length)
+
+        budget, regression = load_budget(opts.budget)
+        failures = []
+
+        print("Baseline  : %s (from sample %d)" % (args[0], sa))
+        print("Candidate : %s (from sample %d)" % (args[1], sb))
+        print("Samples   : %d, units MB/s for STATCOL_*" % length)
+        print("-" * 110)
+        print("%-24s %9s %9s %8s %9s %9s %9s %9s %9s %8s" %
+              ("Column", "Mean A", "Mean B", "Delta", "Peak A", "Peak B",
+               "p95 A", "p95 B", "p99 B", "p-value"))
+        print("-" * 110)
+
+        names = list(a.names) + [n for n in b.names if n not in a.names]
+        for name in names:
+                xs, ys = a.column(name), b.column(name)
+                if not xs or not ys:
+                        print("%-24s missing in %s" %
+                              (name, "baseline" if not xs else "candidate"))
+                        continue
+                stats_a, stats_b = summarise(xs), summarise(ys)
+                t, p = sc.welch_test(sc.block_means(xs, opts.block),
+                                     sc.block_means(ys, opts.block))
+                delta = 100.0 * (stats_b['mean'] - stats_a['mean']) / stats_a['mean'] \
+                        if stats_a['mean'] else 0.0
+                print("%-24s %9.1f %9.1f %7.1f%% %9.1f %9.1f %9.1f %9.1f %9.1f %8.4f" %
+                      (name, stats_a['mean'], stats_b['mean'], delta, stats_a['peak'],
+                       stats_b['peak'], stats_a['p95'], stats_b['p95'], stats_b['p99'], p))
+
+                limit = regression['max_increase_pct']
+                if limit is not None and delta > limit and p < regression['alpha']:
+                        failures.append("%s mean +%.1f%% (p=%.4f)" % (name, delta, p))
+
+                for metric in METRICS:
+                        key = (name, metric)
+                        if key in budget and stats_b[metric] > budget[key]:
+                                failures.append("%s %s %.1f > budget %.1f" %
+                                                (name, metric, stats_b[metric], budget[key]))
+
+        for (name, metric) in budget:
+                if name not in names:
+                        failures.append("%s has a budget but is not in the captures" % name)
+
+        print("-" * 110)
+        if failures:
+                print("FAIL:")
+                for f in failures:
+                        print("   " + f)
+                sys.exit(1)
+        print("PASS")
+
+
+if __name__ == '__main__':
+        main()
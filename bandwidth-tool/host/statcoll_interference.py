@@ -0,0 +1,193 @@
+# Find which initiators interfere with each other in a glsdkstatcoll capture
+#
+# Usage: python statcoll_interference.py [options] statcollector.csv
+#
+# Three views of the same capture:
+#
+#   Pairs      For every pair of initiators, the lag (in samples) with the
+#              most negative cross-correlation, and how much the victim's
+#              bandwidth drops while the aggressor is in its top decile.
+#              A strongly negative r at a small lag means the two are
+#              fighting for the same DDR bandwidth.
+#
+#   Matrix     The most negative r of every pair, aggressors in rows.
+#
+#   Intervals  Runs of samples where the EMIF load is above --saturation of
+#              the theoretical peak while a real-time master (--rt, DSS and
+#              VIP ports by default) runs below --drop of its median, with
+#              the busiest other initiator during the run.
+#
+# License: BSD
+#
+
+from __future__ import print_function, division
+
+import sys
+import optparse
+
+import statcoll_capture as sc
+
+EMIF_TOTALS = ('STATCOL_EMIF1_SYS', 'STATCOL_EMIF2_SYS')
+DEFAULT_RT = ('STATCOL_DSS', 'STATCOL_VIP1_P1', 'STATCOL_VIP1_P2',
+              'STATCOL_VIP2_P1', 'STATCOL_VIP2_P2', 'STATCOL_VIP3_P1',
+              'STATCOL_VIP3_P2')
+
+
+def short(name):
+        return name[len('STATCOL_'):] if name.startswith('STATCOL_') else name
+
+
+def most_negative_lag(xs, ys, max_lag):
+        best, best_r = 0, 2.0
+        for lag in range(-max_lag, max_lag + 1):
+                r = sc.lagged_pearson(xs, ys, lag)
+                if r < best_r:
+                        best, best_r = lag, r
+        return best, best_r
+
+
+def burst_drop(aggressor, victim, pct=90):
+        """Change in victim mean while the aggressor is above its pct
+        percentile, as a percentage of the victim's overall mean"""
+        threshold = sc.percentile(aggressor, pct)
+        during = [v for a, v in zip(aggressor, victim) if a >= threshold and a > 0]
+        overall = sc.mean(victim)
+        if not during or not overall:
+                return 0.0
+        return 100.0 * (sc.mean(during) - overall) / overall
+
+
+def runs(flags):
+        start = None
+        for i, f in enumerate(flags + [False]):
+                if f and start is None:
+                        start = i
+                elif not f and start is not None:
+                        yield start, i
+                        start = None
+
+
+def main():
+        parser = optparse.OptionParser(usage="%prog [options] statcollector.csv")
+        parser.add_option("-i", "--interval-us", type="int", default=30000,
+                          help="INTERVAL_US of the capture [%default]")
+        parser.add_option("-l", "--max-lag", type="int", default=10,
+                          help="largest lag tried, in samples [%default]")
+        parser.add_option("-r", "--min-r", type="float", default=0.3,
+                          help="list pairs with r below -MIN_R [%default]")
+        parser.add_option("--rt", help="comma separated real-time masters "
+                          "[DSS and VIP ports present in the capture]")
+        parser.add_option("-p", "--peak", type="float",
+                          help="theoretical EMIF peak in MB/s "
+                          "[from --ddr-rate, --ddr-width, --num-emif]")
+        parser.add_option("--ddr-rate", type="int", default=1066,
+                          help="DDR data rate in MT/s [%default]")
+        parser.add_option("--ddr-width", type="int", default=32,
+                          help="bus width per EMIF in bits [%default]")
+        parser.add_option("--num-emif", type="int", default=2,
+                          help="number of EMIFs [%default]")
+        parser.add_option("-s", "--saturation", type="float", default=0.7,
+                          help="flag load above this fraction of peak [%default]")
+        parser.add_option("-d", "--drop", type="float", default=0.8,
+                          help="flag real-time masters below this fraction "
+                          "of their median [%default]")
+        parser.add_option("-m", "--min-samples", type="int", default=2,
+                          help="shortest interval reported [%default]")
+        opts, args = parser.parse_args()
+
+        if len(args) != 1:
+                parser.print_help()
+                sys.exit(2)
+
+        cap = sc.load(args[0], opts.interval_us)
+        if cap.samples < 2:
+                print("ERROR: not enough samples in %s" % args[0])
+                sys.exit(2)
+
+        masters = [n for n in cap.statcoll_names() if n not in EMIF_TOTALS and
+                   max(cap.column(n)) > 0]
+        emif = [n for n in EMIF_TOTALS if n in cap.series]
+        load = cap.total(emif) if emif else cap.total(masters)
+        peak = opts.peak or opts.ddr_rate * opts.ddr_width / 8.0 * opts.num_emif
+
+        if opts.rt:
+                rt = ['STATCOL_' + n if not n.startswith('STATCOL_') else n
+                      for n in opts.rt.split(',')]
+        else:
+                rt = [n for n in DEFAULT_RT if n in masters]
+
+        print("Capture   : %s, %d samples of %d us" %
+              (args[0], cap.samples, opts.interval_us))
+        print("EMIF load : %s, mean %.1f MB/s, peak %.1f MB/s of %.1f MB/s" %
+              ("+".join(short(n) for n in emif) or "sum of initiators",
+               sc.mean(load), max(load), peak))
+        print("Real-time : %s" % (", ".join(short(n) for n in rt) or "none"))
+
+        # Pairs
+        pairs = {}
+        for a in masters:
+                for b in masters:
+                        if a == b:
+                                continue
+                        lag, r = most_negative_lag(cap.column(a), cap.column(b),
+                                                   opts.max_lag)
+                        pairs[(a, b)] = (lag, r, burst_drop(cap.column(a), cap.column(b)))
+
+        print()
+        print("%-18s %-18s %5s %7s %10s" %
+              ("Aggressor", "Victim", "Lag", "r", "Drop"))
+        print("-" * 62)
+        listed = sorted([p for p in pairs if pairs[p][1] <= -opts.min_r],
+                        key=lambda p: pairs[p][1])
+        for (a, b) in listed:
+                lag, r, drop = pairs[(a, b)]
+                print("%-18s %-18s %5d %7.2f %9.1f%%" %
+                      (short(a), short(b), lag, r, drop))
+        if not listed:
+                print("no pair below r = -%.2f" % opts.min_r)
+
+        # Matrix
+        print()
+        width = max([len(short(n)) for n in masters] + [6])
+        print(" " * width + "".join(" %7.7s" % short(n) for n in masters))
+        for a in masters:
+                cells = []
+                for b in masters:
+                        cells.append("       -" if a == b else " %7.2f" % pairs[(a, b)][1])
+                print("%-*s%s" % (width, short(a), "".join(cells)))
+
+        # Intervals
+        print()
+        print("Intervals with load above %.0f%% of peak and a real-time master "
+              "below %.0f%% of its median:" % (100 * opts.saturation, 100 * opts.drop))
+        print("%10s %10s %-14s %9s %9s %9s  %s" %
+              ("Start ms", "End ms", "Victim", "Load", "Victim", "Median", "Top other"))
+        print("-" * 90)
+        found = 0
+        saturated = [v >= opts.saturation * peak for v in load]
+        for victim in rt:
+                series = cap.column(victim)
+                median = sc.percentile([v for v in series if v > 0], 50)
+                if not median:
+                        continue
+                flags = [s and v < opts.drop * median
+                         for s, v in zip(saturated, series)]
+                for start, end in runs(flags):
+                        if end - start < opts.min_samples:
+                                continue
+                        others = [n for n in masters if n != victim]
+                        top = max(others, key=lambda n: sc.mean(cap.column(n)[start:end])) \
+                              if others else None
+                        print("%10.1f %10.1f %-14s %9.1f %9.1f %9.1f  %s" %
+                              (start * opts.interval_us / 1000.0,
+                               end * opts.interval_us / 1000.0, short(victim),
+                               sc.mean(load[start:end]), sc.mean(series[start:end]),
+                               median, "%s %.1f" % (short(top),
+                               sc.mean(cap.column(top)[start:end])) if top else ""))
+                        found += 1
+        if not found:
+                print("none")
+
+
+if __name__ == '__main__':
+        main()
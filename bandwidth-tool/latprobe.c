@@ -0,0 +1,420 @@
+/*
+ *  Copyright (c) 2015, Texas Instruments Incorporated
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file       latprobe.c
+ *
+ * @brief      Load-to-use latency probe for the MPU memory hierarchy
+ *
+ *             Walks a randomly ordered ring of cache lines where every load
+ *             depends on the previous one, so each step costs one full
+ *             memory latency. The ring is sized from L1 up to well past the
+ *             L2 to step through the hierarchy into DDR.
+ *
+ *             Each step of the sweep can run under background traffic from
+ *             the traffic generator (-l), or next to a real use case. The
+ *             concurrent bandwidth is taken from the generator and, on the
+ *             target, from the EMIF data counters (-e). The output gives
+ *             latency percentiles against that bandwidth, which is what a
+ *             loaded-latency curve is built from.
+ *
+ *             A sample is one timed batch of dependent loads (-b), and its
+ *             latency is the batch time divided by the loads in it, so the
+ *             percentiles are of batch means: a single slow load is spread
+ *             over the batch. -b 1 times every load on its own, but then
+ *             each sample also carries the cost of reading the clock.
+ *
+ *                 gcc -O2 -o latprobe latprobe.c traffic.c -lpthread
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "traffic.h"
+
+#define PAGE_SIZE 4096
+
+#define EMIF1_BASE 0x4c000000
+#define EMIF2_BASE 0x4d000000
+
+#define EMIF_PERF_CNT_2     0x84
+#define EMIF_PERF_CNT_CFG   0x88
+#define EMIF_PERF_CNT_TIM   0x90
+#define EMIF_PERF_DATA      10
+
+#define LINE_SIZE       64      /* A15 L1/L2 line */
+#define CHASE_BATCH     256     /* default dependent loads per timed sample */
+#define MAX_LOADS       16
+#define MIN_WINDOW_NS   100e6   /* shortest window for the bandwidth figures */
+
+struct chase_node {
+    struct chase_node *next;
+    char pad[LINE_SIZE - sizeof(struct chase_node *)];
+};
+
+struct emif_sample {
+    uint32_t cycles[2];
+    uint32_t data[2];
+};
+
+static volatile uint32_t *emif[2];
+static int num_emif = 2;
+static int ddr_rate = 1066;
+static int ddr_width = 32;
+
+static void *volatile chase_sink;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int emif_open(void)
+{
+    unsigned base[2] = { EMIF1_BASE, EMIF2_BASE };
+    int fd, i;
+
+    fd = open("/dev/mem", O_RDWR);
+    if (fd == -1) {
+        perror("/dev/mem");
+        return -1;
+    }
+
+    for (i = 0; i < num_emif; i++) {
+        void *mem = mmap(NULL, PAGE_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED,
+                         fd, base[i]);
+        if (mem == MAP_FAILED) {
+            printf("ERROR: mmap failed for EMIF%d\n", i + 1);
+            close(fd);
+            return -1;
+        }
+        emif[i] = mem;
+        emif[i][EMIF_PERF_CNT_CFG>>2] = EMIF_PERF_DATA << 16;
+    }
+
+    close(fd);
+    return 0;
+}
+
+static void emif_read(struct emif_sample *s)
+{
+    int i;
+
+    for (i = 0; i < num_emif; i++) {
+        if (!emif[i])
+            continue;
+        s->cycles[i] = emif[i][EMIF_PERF_CNT_TIM>>2];
+        s->data[i] = emif[i][EMIF_PERF_CNT_2>>2];
+    }
+}
+
+/* Achieved DDR bandwidth between two samples, all EMIFs, in MB/s */
+static double emif_mbps(struct emif_sample *s1, struct emif_sample *s2)
+{
+    double mbps = 0;
+    int i;
+
+    for (i = 0; i < num_emif; i++) {
+        uint32_t cycles = s2->cycles[i] - s1->cycles[i];
+        if (emif[i] && cycles)
+            mbps += (double)(s2->data[i] - s1->data[i]) / cycles *
+                    ddr_rate * ddr_width / 8;
+    }
+    return mbps;
+}
+
+/* Sattolo's shuffle: a single cycle through every line of the set */
+static struct chase_node *chase_build(struct chase_node *nodes, size_t n)
+{
+    size_t *order, i, j, tmp;
+
+    order = malloc(n * sizeof(*order));
+    if (!order)
+        return NULL;
+
+    for (i = 0; i < n; i++)
+        order[i] = i;
+    for (i = n - 1; i > 0; i--) {
+        j = rand() % i;
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (i = 0; i < n; i++)
+        nodes[order[i]].next = &nodes[order[(i + 1) % n]];
+
+    free(order);
+    return &nodes[0];
+}
+
+static struct chase_node *chase(struct chase_node *p, size_t steps)
+{
+    while (steps--)
+        p = p->next;
+    return p;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(double *sorted, unsigned n, double pct)
+{
+    unsigned idx = (unsigned)(pct / 100 * (n - 1) + 0.5);
+
+    return sorted[idx < n ? idx : n - 1];
+}
+
+void print_usage()
+{
+    printf("USAGE: glsdklatprobe [options]\n"
+           "\n -m <KB>       smallest working set (default 4)"
+           "\n -M <MB>       largest working set (default 64)"
+           "\n -n <samples>  timed samples per point (default 2000)"
+           "\n -b <loads>    dependent loads per sample, 1 = single loads (default %d)"
+           "\n -o <file>     CSV output (default latprobe.csv)"
+           "\n"
+           "\n Background load from the traffic generator:"
+           "\n -l <list>     comma separated rates in MB/s, 0 = idle, -1 = unlimited"
+           "\n -p <pattern>  read, write, copy or triad (default copy)"
+           "\n -t <threads>  traffic threads (default 1)"
+           "\n -s <MB>       traffic footprint (default 64)"
+           "\n"
+           "\n Concurrent bandwidth from the EMIF counters (target only):"
+           "\n -e            sample the EMIF data counters"
+           "\n -D <MT/s>     DDR data rate (default 1066)"
+           "\n -W <bits>     DDR width per EMIF (default 32)"
+           "\n -E <n>        number of EMIFs, 2 on DRA74x, 1 on DRA72x (default 2)"
+           "\n\n", CHASE_BATCH);
+}
+
+int main(int argc, char **argv)
+{
+    struct traffic_params tparams;
+    struct traffic t;
+    struct emif_sample es1, es2;
+    struct chase_node *nodes, *p;
+    double loads[MAX_LOADS] = { 0 };
+    double *lat, t0, t1, gen_mbps, ddr_mbps;
+    uint64_t b0, b1;
+    size_t ws, min_ws = 4 << 10, max_ws = 64 << 20, n;
+    unsigned samples = 2000, batch = CHASE_BATCH, s;
+    int option, use_emif = 0, num_loads = 1, l;
+    char *outpath = "latprobe.csv", *tok;
+    FILE *outfile;
+
+    memset(&tparams, 0, sizeof(tparams));
+    tparams.pattern = TRAFFIC_COPY;
+    tparams.threads = 1;
+    tparams.footprint = 64 << 20;
+
+    /* Initialize this to turn off verbosity of getopt */
+    opterr = 0;
+
+    while ((option = getopt(argc, argv, "hm:M:n:b:o:l:p:t:s:eD:W:E:")) != -1)
+    {
+        switch(option)
+        {
+            case 'm':
+                min_ws = (size_t)atoi(optarg) << 10;
+                break;
+            case 'M':
+                max_ws = (size_t)atoi(optarg) << 20;
+                break;
+            case 'n':
+                samples = atoi(optarg);
+                break;
+            case 'b':
+                batch = atoi(optarg);
+                break;
+            case 'o':
+                outpath = optarg;
+                break;
+            case 'l':
+                num_loads = 0;
+                for (tok = strtok(optarg, ","); tok && num_loads < MAX_LOADS;
+                     tok = strtok(NULL, ","))
+                    loads[num_loads++] = atof(tok);
+                break;
+            case 'p':
+                tparams.pattern = traffic_pattern_parse(optarg);
+                if ((int)tparams.pattern < 0) {
+                    printf("Unknown pattern %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 't':
+                tparams.threads = atoi(optarg);
+                break;
+            case 's':
+                tparams.footprint = (size_t)atoi(optarg) << 20;
+                break;
+            case 'e':
+                use_emif = 1;
+                break;
+            case 'D':
+                ddr_rate = atoi(optarg);
+                break;
+            case 'W':
+                ddr_width = atoi(optarg);
+                break;
+            case 'E':
+                num_emif = atoi(optarg);
+                break;
+            case 'h':
+                print_usage();
+                exit(0);
+            default:
+                printf("Invalid option.. Exiting\n");
+                print_usage();
+                exit(1);
+        }
+    }
+
+    if (!samples || !batch || !num_loads || min_ws < LINE_SIZE || max_ws < min_ws ||
+        num_emif < 1 || num_emif > 2) {
+        print_usage();
+        exit(1);
+    }
+
+    if (use_emif && emif_open())
+        return 1;
+
+    nodes = malloc(max_ws);
+    lat = malloc(samples * sizeof(*lat));
+    if (!nodes || !lat) {
+        printf("ERROR: could not allocate %zu bytes\n", max_ws);
+        return 1;
+    }
+    memset(nodes, 0, max_ws);
+
+    outfile = fopen(outpath, "w+");
+    if (!outfile) {
+        printf("ERROR: could not open %s\n", outpath);
+        return 1;
+    }
+
+    if (batch > 1)
+        printf("Latency per load, percentiles of the mean over batches of %u loads\n",
+               batch);
+    else
+        printf("Latency per load, percentiles of single loads\n");
+    printf("-----------------------------------------------------------------------------\n");
+    printf("  Load(MB/s)   WS(KB)  Gen(MB/s)  DDR(MB/s)    p50    p90    p99  p99.9    max (ns)\n");
+    printf("-----------------------------------------------------------------------------\n");
+
+    for (l = 0; l < num_loads; l++) {
+        if (loads[l] != 0) {
+            tparams.rate_mbps = loads[l] > 0 ? loads[l] : 0;
+            if (traffic_start(&t, &tparams)) {
+                printf("ERROR: could not start the background traffic\n");
+                return 1;
+            }
+            /* let the generator reach its rate */
+            usleep(200000);
+        }
+
+        for (ws = min_ws; ws <= max_ws; ws *= 2) {
+            n = ws / LINE_SIZE;
+            p = chase_build(nodes, n);
+            if (!p) {
+                printf("ERROR: out of memory\n");
+                return 1;
+            }
+
+            /* one lap to warm up caches and TLBs */
+            p = chase(p, n);
+
+            b0 = loads[l] != 0 ? traffic_bytes(&t) : 0;
+            if (use_emif)
+                emif_read(&es1);
+            t0 = now_ns();
+
+            for (s = 0; s < samples; s++) {
+                double start = now_ns();
+                p = chase(p, batch);
+                lat[s] = (now_ns() - start) / batch;
+            }
+
+            /* small sets finish too quickly to see the generator's chunks */
+            while ((t1 = now_ns()) - t0 < MIN_WINDOW_NS)
+                p = chase(p, CHASE_BATCH);
+
+            if (use_emif)
+                emif_read(&es2);
+            b1 = loads[l] != 0 ? traffic_bytes(&t) : 0;
+            chase_sink = p;
+
+            gen_mbps = (b1 - b0) / (t1 - t0) * 1e3;
+            ddr_mbps = use_emif ? emif_mbps(&es1, &es2) : -1;
+
+            qsort(lat, samples, sizeof(*lat), cmp_double);
+
+            printf("%12.0f %8zu %10.1f %10.1f %6.1f %6.1f %6.1f %6.1f %6.1f\n",
+                   loads[l], ws >> 10, gen_mbps, ddr_mbps,
+                   percentile(lat, samples, 50), percentile(lat, samples, 90),
+                   percentile(lat, samples, 99), percentile(lat, samples, 99.9),
+                   lat[samples - 1]);
+            fprintf(outfile, "load_mbps= %.0f,ws_bytes= %zu,gen_mbps= %.1f,"
+                    "ddr_mbps= %.1f,batch= %u,p50_ns= %.2f,p90_ns= %.2f,"
+                    "p99_ns= %.2f,p999_ns= %.2f,max_ns= %.2f,\n",
+                    loads[l], ws, gen_mbps, ddr_mbps, batch,
+                    percentile(lat, samples, 50), percentile(lat, samples, 90),
+                    percentile(lat, samples, 99), percentile(lat, samples, 99.9),
+                    lat[samples - 1]);
+            fflush(stdout);
+        }
+
+        if (loads[l] != 0) {
+            traffic_stop(&t);
+            traffic_release(&t);
+        }
+    }
+
+    printf("-----------------------------------------------------------------------------\n");
+    printf("Results written to %s\n", outpath);
+
+    fclose(outfile);
+    free(lat);
+    free(nodes);
+    return 0;
+}
@@ -0,0 +1,305 @@
+/*
+ *  Copyright (c) 2015, Texas Instruments Incorporated
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file       memtraffic.c
+ *
+ * @brief      Calibrated memory traffic generator for the MPU cores
+ *
+ *             Generates read, write, copy or triad traffic at a controlled
+ *             rate so that the statistics collector and EMIF readings of
+ *             glsdkstatcoll can be checked against a known load. Without a
+ *             rate it behaves as a STREAM-style bandwidth benchmark and runs
+ *             on any Linux host:
+ *
+ *                 gcc -O2 -o memtraffic memtraffic.c traffic.c -lpthread
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "traffic.h"
+
+#define MAX_COLUMNS 100
+
+static volatile sig_atomic_t stop;
+
+static void sigint_handler(int sig)
+{
+    stop = 1;
+}
+
+void print_usage()
+{
+    printf("USAGE: glsdkmemtraffic [options]\n"
+           "\n -p <pattern>  read, write, copy or triad (default copy)"
+           "\n -n            use non-temporal (streaming) stores"
+           "\n -t <threads>  number of traffic threads (default: online CPUs)"
+           "\n -s <MB>       total footprint of all arrays (default 64)"
+           "\n -r <MB/s>     target rate over all threads, 0 = unlimited (default 0)"
+           "\n -d <secs>     duration of the run (default 10)"
+           "\n -a            pin thread N to CPU N"
+           "\n -i <msecs>    progress report interval (default 1000)"
+           "\n"
+           "\n Checking glsdkstatcoll readings against the generated load:"
+           "\n -c <csv>      statcollector.csv captured while this tool was running"
+           "\n -I <usecs>    INTERVAL_US used for that capture (default 30000)"
+           "\n -T <percent>  tolerance of the check (default 10)"
+           "\n\n");
+}
+
+/*
+ * Mean of the named statcoll column over the samples in which the MPU moved
+ * data, in MB/s. Returns -1 when the column is not in the capture.
+ */
+static int statcoll_read(const char *path, unsigned interval_us,
+                         double *mpu_mbps, double *emif_mbps)
+{
+    FILE *fp;
+    char line[4096], *tok, *eq;
+    double mpu_sum = 0, emif_sum = 0;
+    unsigned samples = 0;
+    int have_mpu = 0, have_emif = 0;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "couldn't open %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof line, fp)) {
+        double mpu = 0, emif = 0;
+
+        for (tok = strtok(line, ",\n"); tok; tok = strtok(NULL, ",\n")) {
+            eq = strchr(tok, '=');
+            if (!eq)
+                continue;
+            if (strstr(tok, "STATCOL_MA_MPU_P") || strstr(tok, "STATCOL_MPU1")) {
+                mpu += atof(eq + 1);
+                have_mpu = 1;
+            }
+            else if (strstr(tok, "STATCOL_EMIF1_SYS") ||
+                     strstr(tok, "STATCOL_EMIF2_SYS")) {
+                emif += atof(eq + 1);
+                have_emif = 1;
+            }
+        }
+
+        if (mpu > 0) {
+            mpu_sum += mpu;
+            emif_sum += emif;
+            samples++;
+        }
+    }
+    fclose(fp);
+
+    if (!have_mpu || !samples) {
+        fprintf(stderr, "ERROR: %s has no active MPU samples "
+                "(configure STATCOL_MA_MPU_P1/P2 in initiators.cfg)\n", path);
+        return -1;
+    }
+
+    /* readings are bytes per sample; bytes per usec is MB/s */
+    *mpu_mbps = mpu_sum / samples / interval_us;
+    *emif_mbps = have_emif ? emif_sum / samples / interval_us : -1;
+    return 0;
+}
+
+static int statcoll_check(const char *path, unsigned interval_us,
+                          double tolerance, double achieved_mbps,
+                          const struct traffic_params *params)
+{
+    double mpu, emif, lo, hi;
+    int fail = 0;
+
+    if (statcoll_read(path, interval_us, &mpu, &emif))
+        return 1;
+
+    lo = achieved_mbps * (1 - tolerance / 100);
+    hi = achieved_mbps * traffic_ddr_factor(params) * (1 + tolerance / 100);
+
+    printf("------------------------------------------------\n");
+    printf("Generated load     : %9.1f MB/s\n", achieved_mbps);
+    printf("Expected at DDR    : %9.1f - %.1f MB/s\n", lo, hi);
+    printf("Statcoll MPU       : %9.1f MB/s  %s\n", mpu,
+           (mpu >= lo && mpu <= hi) ? "PASS" : "FAIL");
+    if (mpu < lo || mpu > hi)
+        fail = 1;
+
+    if (emif >= 0) {
+        /* other masters add to the EMIF total, so only a floor applies */
+        printf("Statcoll EMIF      : %9.1f MB/s  %s\n", emif,
+               emif >= lo ? "PASS" : "FAIL");
+        if (emif < lo)
+            fail = 1;
+    }
+    printf("------------------------------------------------\n");
+
+    return fail;
+}
+
+int main(int argc, char **argv)
+{
+    struct traffic_params params;
+    struct traffic t;
+    int option, i, ret = 0;
+    int duration = 10, report_ms = 1000;
+    unsigned interval_us = 30000;
+    double tolerance = 10, elapsed, last_elapsed = 0, total_mbps;
+    uint64_t bytes, last_bytes = 0;
+    char *csv = NULL;
+
+    memset(&params, 0, sizeof(params));
+    params.pattern = TRAFFIC_COPY;
+    params.threads = sysconf(_SC_NPROCESSORS_ONLN);
+    params.footprint = 64 << 20;
+
+    /* Initialize this to turn off verbosity of getopt */
+    opterr = 0;
+
+    while ((option = getopt(argc, argv, "hp:nt:s:r:d:ai:c:I:T:")) != -1)
+    {
+        switch(option)
+        {
+            case 'p':
+                params.pattern = traffic_pattern_parse(optarg);
+                if ((int)params.pattern < 0) {
+                    printf("Unknown pattern %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 'n':
+                params.nontemporal = 1;
+                break;
+            case 't':
+                params.threads = atoi(optarg);
+                break;
+            case 's':
+                params.footprint = (size_t)atoi(optarg) << 20;
+                break;
+            case 'r':
+                params.rate_mbps = atof(optarg);
+                break;
+            case 'd':
+                duration = atoi(optarg);
+                break;
+            case 'a':
+                params.affinity = 1;
+                break;
+            case 'i':
+                report_ms = atoi(optarg);
+                break;
+            case 'c':
+                csv = optarg;
+                break;
+            case 'I':
+                interval_us = atoi(optarg);
+                break;
+            case 'T':
+                tolerance = atof(optarg);
+                break;
+            case 'h':
+                print_usage();
+                exit(0);
+            default:
+                printf("Invalid option.. Exiting\n");
+                print_usage();
+                exit(1);
+        }
+    }
+
+    if (params.threads <= 0 || duration <= 0 || report_ms <= 0 ||
+        interval_us == 0) {
+        print_usage();
+        exit(1);
+    }
+
+    if (params.nontemporal && !traffic_nontemporal_supported())
+        printf("NOTE: no non-temporal stores on this CPU, using normal stores\n");
+
+    printf("------------------------------------------------\n");
+    printf("Pattern   = %s%s\n", traffic_pattern_name(params.pattern),
+           params.nontemporal ? " (non-temporal)" : "");
+    printf("Threads   = %d%s\n", params.threads,
+           params.affinity ? " (pinned)" : "");
+    printf("Footprint = %zu MB\n", params.footprint >> 20);
+    if (params.rate_mbps > 0)
+        printf("Rate      = %.1f MB/s\n", params.rate_mbps);
+    else
+        printf("Rate      = unlimited\n");
+    printf("Duration  = %d seconds\n", duration);
+    printf("------------------------------------------------\n");
+
+    if (traffic_start(&t, &params)) {
+        fprintf(stderr, "ERROR: could not start the traffic threads\n");
+        return 1;
+    }
+
+    signal(SIGINT, sigint_handler);
+
+    while (!stop) {
+        usleep(report_ms * 1000);
+        elapsed = traffic_elapsed(&t);
+        bytes = traffic_bytes(&t);
+        printf("%8.1f s %10.1f MB/s\n", elapsed,
+               (bytes - last_bytes) / (elapsed - last_elapsed) / 1e6);
+        fflush(stdout);
+        last_bytes = bytes;
+        last_elapsed = elapsed;
+        if (elapsed >= duration)
+            break;
+    }
+
+    elapsed = traffic_elapsed(&t);
+    traffic_stop(&t);
+    bytes = traffic_bytes(&t);
+    total_mbps = bytes / elapsed / 1e6;
+
+    printf("------------------------------------------------\n");
+    for (i = 0; i < params.threads; i++)
+        printf("Thread %2d : %8.3f GB/s\n", i,
+               t.thr[i].bytes / elapsed / 1e9);
+    printf("Total     : %8.3f GB/s (%s, %.1f s)\n", total_mbps / 1000,
+           traffic_pattern_name(params.pattern), elapsed);
+    printf("DDR load  : %8.3f - %.3f GB/s including line fills\n",
+           total_mbps / 1000, total_mbps * traffic_ddr_factor(&params) / 1000);
+    printf("------------------------------------------------\n");
+
+    traffic_release(&t);
+
+    if (csv)
+        ret = statcoll_check(csv, interval_us, tolerance, total_mbps, &params);
+
+    return ret;
+}
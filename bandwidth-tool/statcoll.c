@@ -901,49 +901,64 @@ void statCollectorReadGroup(UInt32 group_id)
 }
 
 
-UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50])
+/* First initiator of every statistics collector, in STATCOL_ID order */
+static const STATCOL_ID statcoll_group_first[10] =
+{
+    STATCOL_EMIF1_SYS,
+    STATCOL_MPU1,
+    STATCOL_VIP1_P1,
+    STATCOL_EVE1_TC0,
+    STATCOL_DSP1_MDMA,
+    STATCOL_DSS,
+    STATCOL_USB3_SS,
+    STATCOL_GMAC_SW,
+    STATCOL_MMC1,
+    STATCOL_OCMC_RAM1
+};
+
+#define STATCOLL_NUM_GROUPS  (sizeof(statcoll_group_first)/sizeof(statcoll_group_first[0]))
+#define STATCOLL_NUM_FILTERS 4
+
+UInt32 statCollectorGroupOf(STATCOL_ID id)
 {
-    int i, fd, index;
-    UInt32 counterIdDss, counterIdIva, counterIdBB2dP1, counterIdBB2dP2, counterIdUsb4, counterIdSata, counterIdEmif1, counterIdEmif2;
+    UInt32 group = 0;
 
-  
-    struct timeval tv1, tv2;
-    gettimeofday(&tv1, NULL);
-#ifndef ANDROID
-    printf("------------------------------------------------\n");
-    printf("Compile time = %s %s\n",__DATE__,  __TIME__);
-    printf("------------------------------------------------\n\n");
-#endif
-    //printd("Start time = %d\n", time(NULL));
-    //printd("Time seconds = %d, usecs = %d\n", tv.tv_sec, tv.tv_usec);
+    while (group + 1 < STATCOLL_NUM_GROUPS && id >= statcoll_group_first[group + 1])
+        group++;
 
-    statcoll_params params;
-    memset(&params, sizeof(params), 0);
-    params.INTERVAL_US = INTERVAL_US;
-    params.TOTAL_TIME = TOTAL_TIME;
+    return group;
+}
 
-    i=0;
-    index=0;
-    while(list[i][0] != 0)
+/* Disable every filter and forget the configured initiators */
+void statCollectorReset()
+{
+    UInt32 group, filter, base;
+    int index;
+
+    for (group = 0; group < STATCOLL_NUM_GROUPS; group++)
     {
-	for(index=0; index< STATCOL_MAX; index++) {
-		if(strcmp(list[i], initiators[index].name) == 0)
-		{
-			strcpy(params.user_config_list[params.no_of_initiators].name, list[i]);
-			params.user_config_list[params.no_of_initiators++].id = initiators[index].id;
-			break;
-		}
-	}
+        base = stat_coll0_base_address + group * 0x1000;
+        for (filter = 0; filter < STATCOLL_NUM_FILTERS; filter++)
+        {
+            wr_stat_reg(base+0xBC+(0x158*filter),0x0);
+            wr_stat_reg(base+0xAC+(0x158*filter),0x0);
+        }
+    }
 
-	if(index == STATCOL_MAX) {
-		printf("ERROR: Unknown initiator \n");
-		exit(0);
-	}
-        i++;
+    for (index = STATCOL_EMIF1_SYS; index < STATCOL_MAX; index++)
+    {
+        free(global_object[index].readings);
+        global_object[index].readings = NULL;
+        global_object[index].b_enabled = 0;
     }
+}
 
-    printf("Total configured initiators = %d\n", params.no_of_initiators);
-	
+static int statcoll_map(void)
+{
+    int fd;
+
+    if (statcoll_base_mem)
+        return 0;
 
     fd = open("/dev/mem", O_RDWR);
     if (fd == -1){
@@ -954,6 +969,7 @@ UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50])
     
    if (statcoll_base_mem == MAP_FAILED){
         printf("ERROR: mmap failed \n");
+        statcoll_base_mem = NULL;
         return -1;
     }
     close(fd);
@@ -971,10 +987,6 @@ UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50])
     close(fd);
 
     printf("SUCCESS: Mapped 0x%x to user space address 0x%x\n", STATCOLL_BASE, statcoll_base_mem);
-    printf("INTERVAL = %d usecs\n", INTERVAL_US);
-    printf("TOTAL TIME = %d seconds\n", TOTAL_TIME);
-    TRACE_SZ = (TOTAL_TIME * 1000000)/INTERVAL_US;
-    printf("TRACE SIZE = %d samples\n", TRACE_SZ);
 
     printf("**************************************\n");
     printf("Going to initialize the L3 clocks \n"); 
@@ -987,18 +999,31 @@ UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50])
 	printf("Waiting on module to be functional\n");
     }
 
+    return 0;
+}
+
+static UInt32 statcoll_capture(statcoll_params *params)
+{
+    int i, index;
+
+    printf("INTERVAL = %d usecs\n", params->INTERVAL_US);
+    printf("TOTAL TIME = %d seconds\n", params->TOTAL_TIME);
+    TRACE_SZ = (params->TOTAL_TIME * 1000000)/params->INTERVAL_US;
+    printf("TRACE SIZE = %d samples\n", TRACE_SZ);
+
     statCollectorInit();
 
     printf("SUCCESS: Initialized STAT COLLECTOR\n");
     /* Initialize all enabled initiators */
-    for(index =0; index < params.no_of_initiators; index++) {
-        printf("\t\t Initialized %s\n", params.user_config_list[index].name);
-        statCollectorControlInitialize(params.user_config_list[index].id);
+    for(index =0; index < params->no_of_initiators; index++) {
+        printf("\t\t Initialized %s\n", params->user_config_list[index].name);
+        statCollectorControlInitialize(params->user_config_list[index].id);
     }
 
+    statCountIdx = 0;
     while(statCountIdx != (TRACE_SZ - 1))
     {
-        usleep(INTERVAL_US);
+        usleep(params->INTERVAL_US);
         int group;
 	for(group = 1; group<11; group++)
 		statCollectorReadGroup(group);
@@ -1015,23 +1040,234 @@ UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50])
 #endif
     if (!outfile) {
         printf("\n ERROR: Error opening file");
+        return -1;
     }
 
     /* Ignore the first index at 0 */
     for(index=1; index<statCountIdx; index++) {
-	    for(i=0; i<params.no_of_initiators; i++) {
-		    fprintf(outfile,"%s = %d,", params.user_config_list[i].name, global_object[params.user_config_list[i].id].readings[index]);
+	    for(i=0; i<params->no_of_initiators; i++) {
+		    fprintf(outfile,"%s = %d,", params->user_config_list[i].name, global_object[params->user_config_list[i].id].readings[index]);
 	    }
 	    fprintf(outfile,"\n"); 
     }
     fclose(outfile);
 
+    return 0;
+}
+
+UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50])
+{
+    int i, index;
+    UInt32 ret;
+  
+    struct timeval tv1, tv2;
+    gettimeofday(&tv1, NULL);
+#ifndef ANDROID
+    printf("------------------------------------------------\n");
+    printf("Compile time = %s %s\n",__DATE__,  __TIME__);
+    printf("------------------------------------------------\n\n");
+#endif
+    //printd("Start time = %d\n", time(NULL));
+    //printd("Time seconds = %d, usecs = %d\n", tv.tv_sec, tv.tv_usec);
+
+    statcoll_params params;
+    memset(&params, 0, sizeof(params));
+    params.INTERVAL_US = INTERVAL_US;
+    params.TOTAL_TIME = TOTAL_TIME;
+
+    i=0;
+    index=0;
+    while(list[i][0] != 0)
+    {
+	for(index=0; index< STATCOL_MAX; index++) {
+		if(strcmp(list[i], initiators[index].name) == 0)
+		{
+			strcpy(params.user_config_list[params.no_of_initiators].name, list[i]);
+			params.user_config_list[params.no_of_initiators++].id = initiators[index].id;
+			break;
+		}
+	}
+
+	if(index == STATCOL_MAX) {
+		printf("ERROR: Unknown initiator \n");
+		exit(0);
+	}
+        i++;
+    }
+
+    printf("Total configured initiators = %d\n", params.no_of_initiators);
+	
+    if (statcoll_map())
+        return -1;
+
+    ret = statcoll_capture(&params);
+
     gettimeofday(&tv2, NULL);
     //printf("End time = %d\n", time(NULL));
     //printf("Time seconds = %d, usecs = %d\n", tv.tv_sec, tv.tv_usec);
     printf("Total execution time = %d secs, %d usecs\n\n", (tv2.tv_sec - tv1.tv_sec), (tv2.tv_usec - tv2.tv_usec));
 
-    return 0;
+    return ret;
+}
+
+/*
+ * Top-talker discovery
+ *
+ * Each statistics collector serves up to 8 initiators but has only 4
+ * filters, so all 74 initiators cannot be watched at once. The scan phase
+ * rotates through windows, each window programming the next 4 initiators
+ * of every collector, until DISCOVERY_TIME has elapsed. The initiators are
+ * then ranked by their average traffic while they were watched, and the
+ * rest of TOTAL_TIME is captured at full resolution on the EMIF totals and
+ * the TOP_N busiest initiators that still fit in their collector.
+ */
+static double discovery_rate[STATCOL_MAX];
+
+static int discovery_cmp(const void *a, const void *b)
+{
+    double x = discovery_rate[*(const int *)a];
+    double y = discovery_rate[*(const int *)b];
+
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static int is_emif_total(int id)
+{
+    return id == STATCOL_EMIF1_SYS || id == STATCOL_EMIF2_SYS;
 }
 
+UInt32 statcoll_discover(UInt32 TOTAL_TIME, UInt32 INTERVAL_US,
+                         UInt32 DISCOVERY_TIME, UInt32 DISCOVERY_WINDOW_US,
+                         UInt32 TOP_N)
+{
+    unsigned long long bytes[STATCOL_MAX];
+    UInt32 samples[STATCOL_MAX];
+    UInt32 used[STATCOLL_NUM_GROUPS];
+    int member[STATCOLL_NUM_GROUPS][8], count[STATCOLL_NUM_GROUPS];
+    int rank[STATCOL_MAX], num_ranked = 0, picked = 0;
+    int windows = 0, window, group, id, i, k;
+    unsigned elapsed_us = 0;
+    char list[STATCOL_MAX + 1][50];
+    FILE *outfile;
+
+    if (DISCOVERY_TIME >= TOTAL_TIME) {
+        printf("ERROR: DISCOVERY_TIME must be shorter than TOTAL_TIME\n");
+        return -1;
+    }
+    if (DISCOVERY_WINDOW_US < 2 * INTERVAL_US)
+        DISCOVERY_WINDOW_US = 2 * INTERVAL_US;
+
+    memset(bytes, 0, sizeof(bytes));
+    memset(samples, 0, sizeof(samples));
+    memset(count, 0, sizeof(count));
+
+    for (id = 0; id < STATCOL_MAX; id++) {
+        group = statCollectorGroupOf(id);
+        member[group][count[group]++] = id;
+    }
+    for (group = 0; group < STATCOLL_NUM_GROUPS; group++) {
+        k = (count[group] + STATCOLL_NUM_FILTERS - 1) / STATCOLL_NUM_FILTERS;
+        if (k > windows)
+            windows = k;
+    }
+
+    printf("DISCOVERY: scanning %d initiators in %d windows of %d usecs for %d seconds\n",
+           STATCOL_MAX, windows, DISCOVERY_WINDOW_US, DISCOVERY_TIME);
+
+    if (statcoll_map())
+        return -1;
+
+    /* Only the latest reading of each initiator is needed while scanning */
+    TRACE_SZ = 1;
+    statCountIdx = 0;
+
+    while (elapsed_us < DISCOVERY_TIME * 1000000)
+    {
+        for (window = 0; window < windows; window++)
+        {
+            statCollectorInit();
+            for (group = 0; group < STATCOLL_NUM_GROUPS; group++)
+                for (k = window * STATCOLL_NUM_FILTERS;
+                     k < count[group] && k < (window + 1) * STATCOLL_NUM_FILTERS; k++)
+                    statCollectorControlInitialize(member[group][k]);
+
+            /* The first reading covers the reconfiguration, drop it */
+            usleep(INTERVAL_US);
+            for (group = 1; group < 11; group++)
+                statCollectorReadGroup(group);
+
+            for (i = INTERVAL_US; i < DISCOVERY_WINDOW_US; i += INTERVAL_US)
+            {
+                usleep(INTERVAL_US);
+                for (group = 1; group < 11; group++)
+                    statCollectorReadGroup(group);
+
+                for (id = 0; id < STATCOL_MAX; id++) {
+                    if (global_object[id].b_enabled) {
+                        bytes[id] += global_object[id].readings[0];
+                        samples[id]++;
+                    }
+                }
+            }
+
+            elapsed_us += DISCOVERY_WINDOW_US;
+            statCollectorReset();
+        }
+    }
+
+    for (id = 0; id < STATCOL_MAX; id++) {
+        discovery_rate[id] = samples[id] ?
+                             (double)bytes[id] / samples[id] / INTERVAL_US : 0;
+        if (!is_emif_total(id))
+            rank[num_ranked++] = id;
+    }
+    qsort(rank, num_ranked, sizeof(rank[0]), discovery_cmp);
+
+#ifdef ANDROID
+    outfile = fopen("/data/statcoll/statcoll-discovery.csv", "w+");
+#else
+    outfile = fopen("statcoll-discovery.csv", "w+");
+#endif
+
+    /* EMIF totals are always kept, they share collector 0 with the MPU */
+    memset(used, 0, sizeof(used));
+    memset(list, 0, sizeof(list));
+    k = 0;
+    strcpy(list[k++], initiators[STATCOL_EMIF1_SYS].name);
+    strcpy(list[k++], initiators[STATCOL_EMIF2_SYS].name);
+    used[0] = 2;
+
+    printf("------------------------------------------------\n");
+    printf(" Rank  Initiator                  MB/s   Focus\n");
+    printf("------------------------------------------------\n");
+    for (i = 0; i < num_ranked; i++) {
+        int focus = 0;
+
+        id = rank[i];
+        group = statCollectorGroupOf(id);
+        /* when a collector is full the next initiator in line takes the slot */
+        if (picked < TOP_N && discovery_rate[id] > 0 &&
+            used[group] < STATCOLL_NUM_FILTERS) {
+            strcpy(list[k++], initiators[id].name);
+            used[group]++;
+            picked++;
+            focus = 1;
+        }
+
+        if (discovery_rate[id] > 0)
+            printf(" %4d  %-24s %8.1f   %s\n", i + 1, initiators[id].name,
+                   discovery_rate[id], focus ? "yes" : "");
+        if (outfile)
+            fprintf(outfile, "%s = %.0f,", initiators[id].name,
+                    discovery_rate[id] * INTERVAL_US);
+    }
+    printf("------------------------------------------------\n\n");
+
+    if (outfile) {
+        fprintf(outfile, "\n");
+        fclose(outfile);
+    }
+
+    return statcoll_start(TOTAL_TIME - DISCOVERY_TIME, INTERVAL_US, list);
+}
 
@@ -149,5 +149,8 @@ typedef struct
 }statcoll_initiators_object;
 
 UInt32 statcoll_start(UInt32 TOTAL_TIME, UInt32 INTERVAL_US, char list[][50]);
+UInt32 statcoll_discover(UInt32 TOTAL_TIME, UInt32 INTERVAL_US,
+                         UInt32 DISCOVERY_TIME, UInt32 DISCOVERY_WINDOW_US,
+                         UInt32 TOP_N);
 
 #endif
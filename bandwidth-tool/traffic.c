@@ -0,0 +1,386 @@
+/*
+ *  Copyright (c) 2015, Texas Instruments Incorporated
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file       traffic.c
+ *
+ * @brief      STREAM-style memory traffic kernels used to put a known load
+ *             on the DDR from the MPU cores
+ *
+ *             Every thread owns its own arrays and walks them in chunks.
+ *             After each chunk the moved bytes are published and, when a
+ *             rate is requested, the thread sleeps until the absolute time
+ *             at which that many bytes are due. Bytes are counted the way
+ *             STREAM counts them: one read plus one write per stored element
+ *             for copy, two reads plus one write for triad.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "traffic.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Elements per chunk: 64 KB per array, small enough to pace accurately */
+#define TRAFFIC_CHUNK   8192
+
+static const char *pattern_names[TRAFFIC_MAX] = {
+    "read",
+    "write",
+    "copy",
+    "triad",
+};
+
+/* Arrays read and written per element, indexed by pattern */
+static const int pattern_reads[TRAFFIC_MAX]  = { 1, 0, 1, 2 };
+static const int pattern_writes[TRAFFIC_MAX] = { 0, 1, 1, 1 };
+
+static volatile double traffic_sink;
+
+const char *traffic_pattern_name(TRAFFIC_PATTERN pattern)
+{
+    if (pattern < 0 || pattern >= TRAFFIC_MAX)
+        return "unknown";
+    return pattern_names[pattern];
+}
+
+int traffic_pattern_parse(const char *name)
+{
+    int i;
+
+    for (i = 0; i < TRAFFIC_MAX; i++)
+        if (strcmp(name, pattern_names[i]) == 0)
+            return i;
+
+    return -1;
+}
+
+int traffic_nontemporal_supported(void)
+{
+#if defined(__SSE2__) || defined(__aarch64__)
+    return 1;
+#else
+    /* ARMv7 has no streaming store hint */
+    return 0;
+#endif
+}
+
+/*
+ * With normal stores a write miss first fills the line from DDR, so every
+ * written byte costs a read as well. This is an upper bound: the A15 spots
+ * full-line streaming writes and skips the fill.
+ */
+double traffic_ddr_factor(const struct traffic_params *params)
+{
+    int r = pattern_reads[params->pattern];
+    int w = pattern_writes[params->pattern];
+
+    if (params->nontemporal && traffic_nontemporal_supported())
+        return 1.0;
+
+    return (double)(r + 2 * w) / (r + w);
+}
+
+static inline void store_nt2(double *p, double x0, double x1)
+{
+#if defined(__SSE2__)
+    _mm_stream_pd(p, _mm_set_pd(x1, x0));
+#elif defined(__aarch64__)
+    __asm__ volatile("stnp %d0, %d1, [%2]"
+                     : : "w"(x0), "w"(x1), "r"(p) : "memory");
+#else
+    p[0] = x0;
+    p[1] = x1;
+#endif
+}
+
+static inline void store_fence(void)
+{
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
+static double kernel_read(double *a, size_t n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        s0 += a[i];
+        s1 += a[i + 1];
+        s2 += a[i + 2];
+        s3 += a[i + 3];
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+static void kernel_write(double *a, size_t n, double s, int nt)
+{
+    size_t i;
+
+    if (nt) {
+        for (i = 0; i < n; i += 2)
+            store_nt2(&a[i], s, s);
+        store_fence();
+        return;
+    }
+    for (i = 0; i < n; i++)
+        a[i] = s;
+}
+
+static void kernel_copy(double *c, const double *a, size_t n, int nt)
+{
+    size_t i;
+
+    if (nt) {
+        for (i = 0; i < n; i += 2)
+            store_nt2(&c[i], a[i], a[i + 1]);
+        store_fence();
+        return;
+    }
+    for (i = 0; i < n; i++)
+        c[i] = a[i];
+}
+
+static void kernel_triad(double *a, const double *b, const double *c,
+                         size_t n, double q, int nt)
+{
+    size_t i;
+
+    if (nt) {
+        for (i = 0; i < n; i += 2)
+            store_nt2(&a[i], b[i] + q * c[i], b[i + 1] + q * c[i + 1]);
+        store_fence();
+        return;
+    }
+    for (i = 0; i < n; i++)
+        a[i] = b[i] + q * c[i];
+}
+
+static void timespec_add_ns(struct timespec *ts, uint64_t ns)
+{
+    ns += ts->tv_nsec;
+    ts->tv_sec += ns / 1000000000ull;
+    ts->tv_nsec = ns % 1000000000ull;
+}
+
+static void *traffic_thread_fxn(void *arg)
+{
+    struct traffic_thread *thr = arg;
+    struct traffic *t = thr->owner;
+    TRAFFIC_PATTERN pattern = t->params.pattern;
+    int nt = t->params.nontemporal && traffic_nontemporal_supported();
+    size_t per_elem = sizeof(double) *
+                      (pattern_reads[pattern] + pattern_writes[pattern]);
+    double rate = t->params.rate_mbps * 1000000.0 / t->params.threads;
+    double sum = 0;
+    uint64_t bytes = 0;
+    size_t pos = 0, n;
+    struct timespec due;
+
+    if (t->params.affinity) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(thr->id % sysconf(_SC_NPROCESSORS_ONLN), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    while (!t->stop) {
+        n = thr->len - pos;
+        if (n > TRAFFIC_CHUNK)
+            n = TRAFFIC_CHUNK;
+
+        switch (pattern) {
+        case TRAFFIC_READ:
+            sum += kernel_read(thr->a + pos, n);
+            break;
+        case TRAFFIC_WRITE:
+            kernel_write(thr->a + pos, n, (double)bytes, nt);
+            break;
+        case TRAFFIC_COPY:
+            kernel_copy(thr->c + pos, thr->a + pos, n, nt);
+            break;
+        case TRAFFIC_TRIAD:
+            kernel_triad(thr->a + pos, thr->b + pos, thr->c + pos, n, 3.0, nt);
+            break;
+        default:
+            break;
+        }
+
+        bytes += n * per_elem;
+        __atomic_store_n(&thr->bytes, bytes, __ATOMIC_RELAXED);
+
+        pos += n;
+        if (pos >= thr->len)
+            pos = 0;
+
+        if (rate > 0) {
+            due = t->start;
+            timespec_add_ns(&due, (uint64_t)(bytes / rate * 1e9));
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL)
+                   == EINTR)
+                ;
+        }
+    }
+
+    traffic_sink = sum;
+    return NULL;
+}
+
+static double *traffic_alloc(size_t len)
+{
+    void *p;
+    size_t i;
+
+    if (posix_memalign(&p, 64, len * sizeof(double)))
+        return NULL;
+
+    /* Touch every page now so the run does not measure page faults */
+    for (i = 0; i < len; i++)
+        ((double *)p)[i] = 1.0;
+
+    return p;
+}
+
+int traffic_start(struct traffic *t, const struct traffic_params *params)
+{
+    int i, ret, arrays;
+    size_t len;
+
+    memset(t, 0, sizeof(*t));
+    t->params = *params;
+
+    if (params->pattern < 0 || params->pattern >= TRAFFIC_MAX ||
+        params->threads <= 0)
+        return -1;
+
+    arrays = params->pattern == TRAFFIC_TRIAD ? 3 :
+             params->pattern == TRAFFIC_COPY ? 2 : 1;
+    len = params->footprint / params->threads / arrays / sizeof(double);
+    len &= ~(size_t)3;
+    if (len < 4)
+        len = 4;
+
+    t->thr = calloc(params->threads, sizeof(*t->thr));
+    if (!t->thr)
+        return -1;
+
+    for (i = 0; i < params->threads; i++) {
+        struct traffic_thread *thr = &t->thr[i];
+
+        thr->id = i;
+        thr->owner = t;
+        thr->len = len;
+        thr->a = traffic_alloc(len);
+        if (arrays > 1)
+            thr->c = traffic_alloc(len);
+        if (arrays > 2)
+            thr->b = traffic_alloc(len);
+        if (!thr->a || (arrays > 1 && !thr->c) || (arrays > 2 && !thr->b)) {
+            fprintf(stderr, "ERROR: could not allocate %zu bytes\n",
+                    len * sizeof(double));
+            traffic_stop(t);
+            traffic_release(t);
+            return -1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t->start);
+
+    for (i = 0; i < params->threads; i++) {
+        ret = pthread_create(&t->thr[i].thread_id, NULL, traffic_thread_fxn,
+                             &t->thr[i]);
+        if (ret) {
+            fprintf(stderr, "ERROR: can't spawn traffic thread %d: %s\n",
+                    i, strerror(ret));
+            traffic_stop(t);
+            traffic_release(t);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+uint64_t traffic_bytes(struct traffic *t)
+{
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < t->params.threads; i++)
+        total += __atomic_load_n(&t->thr[i].bytes, __ATOMIC_RELAXED);
+
+    return total;
+}
+
+double traffic_elapsed(struct traffic *t)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - t->start.tv_sec) +
+           (now.tv_nsec - t->start.tv_nsec) / 1e9;
+}
+
+void traffic_stop(struct traffic *t)
+{
+    int i;
+
+    t->stop = 1;
+
+    if (!t->thr)
+        return;
+
+    for (i = 0; i < t->params.threads; i++) {
+        if (t->thr[i].thread_id)
+            pthread_join(t->thr[i].thread_id, NULL);
+        t->thr[i].thread_id = 0;
+        free(t->thr[i].a);
+        free(t->thr[i].b);
+        free(t->thr[i].c);
+        t->thr[i].a = t->thr[i].b = t->thr[i].c = NULL;
+    }
+}
+
+void traffic_release(struct traffic *t)
+{
+    free(t->thr);
+    t->thr = NULL;
+}
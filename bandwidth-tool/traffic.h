@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2015, Texas Instruments Incorporated
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __TRAFFIC_H
+#define __TRAFFIC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef enum
+{
+    TRAFFIC_READ,
+    TRAFFIC_WRITE,
+    TRAFFIC_COPY,
+    TRAFFIC_TRIAD,
+    TRAFFIC_MAX
+} TRAFFIC_PATTERN;
+
+struct traffic_params
+{
+    TRAFFIC_PATTERN pattern;
+    int nontemporal;        /* use streaming stores where the CPU has them */
+    int threads;
+    size_t footprint;       /* total bytes touched per pass, all threads */
+    double rate_mbps;       /* total target rate, 0 = as fast as possible */
+    int affinity;           /* pin thread N to CPU N */
+};
+
+struct traffic_thread
+{
+    pthread_t thread_id;
+    int id;
+    struct traffic *owner;
+    double *a, *b, *c;
+    size_t len;             /* elements per array */
+    uint64_t bytes;         /* bytes moved so far, updated per chunk */
+};
+
+struct traffic
+{
+    struct traffic_params params;
+    struct traffic_thread *thr;
+    struct timespec start;
+    volatile int stop;
+};
+
+const char *traffic_pattern_name(TRAFFIC_PATTERN pattern);
+int traffic_pattern_parse(const char *name);
+int traffic_nontemporal_supported(void);
+
+/* Number of bytes the DDR sees per byte counted by the generator */
+double traffic_ddr_factor(const struct traffic_params *params);
+
+int traffic_start(struct traffic *t, const struct traffic_params *params);
+uint64_t traffic_bytes(struct traffic *t);
+double traffic_elapsed(struct traffic *t);
+void traffic_stop(struct traffic *t);    /* per-thread byte counts stay valid */
+void traffic_release(struct traffic *t);
+
+#endif
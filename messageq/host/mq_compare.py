@@ -0,0 +1,225 @@
+# Compare a MessageQZCpy run against a stored baseline
+#
+# Usage: python mq_compare.py [options] baseline.json candidate.json
+#
+# Both files are written by MessageQZCpy -j. Threads are matched by their
+# number; a thread whose config differs between the two runs is reported
+# and not compared. Two sweeps (-s) are compared point by point the same
+# way, a point's config being its swept values. For every thread the rate,
+# one-way latency, round trip time and send lag of both runs are printed
+# with the change. The exit status is non-zero when the candidate has
+# errors the baseline did not, loses messages, or regresses a metric
+# beyond its threshold.
+#
+# Threshold file:
+#   [regression]
+#   rate = 5                ; % drop of the achieved message rate
+#   latency.p99 = 25        ; % increase
+#   rtt.p50 = 10
+#   min_abs_us = 50         ; ignore latency changes smaller than this
+#
+# Metrics are rate, mbps and {latency,rtt,lag}.{p50,p99,p999,max,mean}.
+#
+# License: BSD
+#
+
+from __future__ import print_function, division
+
+import sys
+import json
+import optparse
+
+try:
+        import ConfigParser as configparser
+except ImportError:
+        import configparser
+
+HISTS = (('latency', 'latency_us'), ('rtt', 'rtt_us'), ('lag', 'send_lag_us'))
+STATS = ('p50', 'p99', 'p999', 'max', 'mean')
+HIGHER_IS_BETTER = ('rate', 'mbps')
+
+DEFAULT_THRESHOLDS = {
+        'rate': 5.0,
+        'mbps': 5.0,
+        'latency.p50': 25.0,
+        'latency.p99': 25.0,
+        'rtt.p50': 25.0,
+        'rtt.p99': 25.0,
+}
+
+
+def load(path):
+        try:
+                ifile = open(path, 'r')
+                run = json.load(ifile)
+                ifile.close()
+        except (IOError, ValueError) as e:
+                print("ERROR: couldn't read %s: %s" % (path, e))
+                sys.exit(2)
+        if run.get('version') != 1:
+                print("ERROR: %s is results version %s, expected 1" %
+                      (path, run.get('version')))
+                sys.exit(2)
+        return run
+
+
+def load_thresholds(path, default_pct):
+        thresholds = dict(DEFAULT_THRESHOLDS)
+        if default_pct is not None:
+                for key in thresholds:
+                        thresholds[key] = default_pct
+        min_abs_us = 50.0
+        if not path:
+                return thresholds, min_abs_us
+
+        # no interpolation, so '%' is fine in a comment; python 3 needs
+        # to be told about inline comments, python 2 strips them itself
+        try:
+                config = configparser.RawConfigParser(inline_comment_prefixes=(';',))
+        except TypeError:
+                config = configparser.RawConfigParser()
+        config.optionxform = str
+        if not config.read(path):
+                print("ERROR: couldn't read threshold file %s" % path)
+                sys.exit(2)
+        if config.has_section('regression'):
+                for key, value in config.items('regression'):
+                        value = float(value)
+                        if key == 'min_abs_us':
+                                min_abs_us = value
+                                continue
+                        name = key.split('.')
+                        if not (key in HIGHER_IS_BETTER or
+                                (len(name) == 2 and name[0] in dict(HISTS) and
+                                 name[1] in STATS)):
+                                print("ERROR: unknown metric %s in %s" % (key, path))
+                                sys.exit(2)
+                        thresholds[key] = value
+        return thresholds, min_abs_us
+
+
+def metrics(thread):
+        m = {'rate': thread['rate'], 'mbps': thread['mbps']}
+        for short, field in HISTS:
+                hist = thread.get(field)
+                if hist:
+                        for stat in STATS:
+                                m['%s.%s' % (short, stat)] = hist[stat]
+        return m
+
+
+def entries(run):
+        """Threads of a run or points of a sweep, by number"""
+        if 'points' in run:
+                return dict((p['point'], p) for p in run['points'])
+        return dict((t['thread'], t) for t in run['threads'])
+
+
+def errors(thread):
+        return sum(thread['errors'].values())
+
+
+def change(a, b):
+        return 100.0 * (b - a) / a if a else 0.0
+
+
+def environment(run):
+        env = run['environment']
+        return "%s, %s %s, %d cpus, %s, %s, %s buffer" % (env['date'], env['host'],
+                                                          env['kernel'], env['cpus'],
+                                                          env['transport'],
+                                                          run['config']['mode'],
+                                                          run['config'].get('buffer', 'wc'))
+
+
+def main():
+        parser = optparse.OptionParser(
+                usage="%prog [options] baseline.json candidate.json")
+        parser.add_option("-t", "--threshold", type="float",
+                          help="percent allowed for every default metric [5 for "
+                          "rates, 25 for latencies]")
+        parser.add_option("-c", "--config", help="threshold ini file")
+        parser.add_option("-a", "--all", action="store_true", default=False,
+                          help="print every metric, not only the thresholded ones")
+        opts, args = parser.parse_args()
+
+        if len(args) != 2:
+                parser.print_help()
+                sys.exit(2)
+
+        a, b = load(args[0]), load(args[1])
+        if ('points' in a) != ('points' in b):
+                print("ERROR: can't compare a sweep with a single run")
+                sys.exit(2)
+        unit = 'Point' if 'points' in a else 'Thread'
+        thresholds, min_abs_us = load_thresholds(opts.config, opts.threshold)
+        failures = []
+
+        print("Baseline  : %s (%s)" % (args[0], environment(a)))
+        print("Candidate : %s (%s)" % (args[1], environment(b)))
+        if a['environment']['transport'] != b['environment']['transport']:
+                print("WARNING: comparing a %s run with a %s run" %
+                      (a['environment']['transport'], b['environment']['transport']))
+        print("-" * 86)
+        print("%-7s %-13s %-13s %12s %12s %9s  %s" %
+              (unit, "Direction", "Metric", "Baseline", "Candidate", "Change", ""))
+        print("-" * 86)
+
+        threads_a, threads_b = entries(a), entries(b)
+        for num in sorted(set(threads_a) | set(threads_b)):
+                if num not in threads_a or num not in threads_b:
+                        print("%-7d only in the %s" %
+                              (num, "baseline" if num in threads_a else "candidate"))
+                        continue
+                ta, tb = threads_a[num], threads_b[num]
+                if ta['config'] != tb['config']:
+                        diff = ["%s %s->%s" % (k, ta['config'][k], tb['config'].get(k))
+                                for k in sorted(ta['config'])
+                                if ta['config'][k] != tb['config'].get(k)]
+                        print("%-7d config differs (%s), not compared" % (num, ", ".join(diff)))
+                        continue
+
+                if errors(tb) > errors(ta):
+                        failures.append("%s %d: %d errors %s" %
+                                        (unit.lower(), num, errors(tb), tb['errors']))
+                if tb['messages'] < ta['messages']:
+                        failures.append("%s %d: %d of %d messages" %
+                                        (unit.lower(), num, tb['messages'], ta['messages']))
+
+                ma, mb = metrics(ta), metrics(tb)
+                for key in sorted(set(ma) & set(mb)):
+                        limit = thresholds.get(key)
+                        if limit is None and not opts.all:
+                                continue
+                        delta = change(ma[key], mb[key])
+                        worse = -delta if key in HIGHER_IS_BETTER else delta
+                        flag = ""
+                        if limit is not None and worse > limit and \
+                           (key in HIGHER_IS_BETTER or abs(mb[key] - ma[key]) >= min_abs_us):
+                                flag = "REGRESSED"
+                                failures.append("%s %d %s: %.1f -> %.1f (%+.1f%%, limit %.0f%%)" %
+                                                (unit.lower(), num, key, ma[key], mb[key],
+                                                 delta, limit))
+                        print("%-7d %-13s %-13s %12.1f %12.1f %8.1f%%  %s" %
+                              (num, ta['direction'], key, ma[key], mb[key], delta, flag))
+
+        print("-" * 86)
+        print("Process   : user+sys %.1f -> %.1f ms, context switches %d -> %d" %
+              (a['process']['user_ms'] + a['process']['sys_ms'],
+               b['process']['user_ms'] + b['process']['sys_ms'],
+               a['process']['voluntary_cs'] + a['process']['involuntary_cs'],
+               b['process']['voluntary_cs'] + b['process']['involuntary_cs']))
+        if 'startup' in a and 'startup' in b:
+                print("Start-up  : remote queue %.1f -> %.1f ms, first message %.1f -> %.1f ms" %
+                      (a['startup']['ready_ms'], b['startup']['ready_ms'],
+                       a['startup']['first_msg_ms'], b['startup']['first_msg_ms']))
+        if failures:
+                print("FAIL:")
+                for f in failures:
+                        print("   " + f)
+                sys.exit(1)
+        print("PASS")
+
+
+if __name__ == '__main__':
+        main()
@@ -34,6 +34,8 @@
  *
  *  Test for messageq operating in multiple simultaneous threads.
  *
+ *  The protocol lives in mq_remote.c, this file is its SYS/BIOS side:
+ *  the mq_remote_os.h calls, the MmRpc service and the tasks.
  */
 
 #include <xdc/std.h>
@@ -55,48 +57,14 @@
 #include <ti/sysbios/hal/Cache.h>
 
 #include <ti/ipc/tests/load_task.h>
+#include <ti/ipc/tests/mq_remote.h>
 
-#define SLAVE_MESSAGEQNAME "SLAVE"
-#define HOST_MESSAGEQNAME "HOST"
-#define A15_MESSAGEQNAME   "A15"
-#define M4_MESSAGEQNAME    "M4"
-
-static unsigned int numThreads;
-
-enum ThreadDirection {
-        unidirectional_send = 0,
-        unidirectional_recv,
-        bidirectional
-};
-
-typedef struct SyncMsg {
-    unsigned int boBufPayloadPtr; /*Shared Region pointer address to be exchanged using MessageQ*/
-    unsigned int boBufPayloadSize; /*Shared Region pointer address  Size*/
-    unsigned int numThread; /* Indicates the number of threads to the other core: Handshake */
-    unsigned int numMessages; /* Indicates the number of messages: Handshake */
-    unsigned int numWaitTime; /* Indicates the sleep/wait between send messages: Handshake */
-    unsigned int payloadSize; /* Indicates the size of the payload which will be carried by each message: Handshake */
-    unsigned int procId; /* Indicates the size of the payload which will be carried by each message: Handshake */
-    unsigned int thrDirection; /* Used a double to use each bit field for a thread. hence restriction of 64 threads*/
-    Task_Handle thrId;
- } SyncMsg;
-
-
-typedef struct RemoteBufSyncMsg {
-    MessageQ_MsgHeader header;
-    unsigned int *boBufPayloadPtr; /*Shared Region pointer address to be exchanged using MessageQ*/
-    unsigned int boBufPayloadSize; /*Shared Region pointer address  Size*/
-} RemoteBufSyncMsg;
-
-static int gFinishedCounter = 0;
-
-#define MessageQ_payload(m) ((void *)((char *)(m) + sizeof(MessageQ_MsgHeader)))
+/* 32K sync counter through its L3 alias, shared with the host for one-way latency */
+#define SYNC_COUNTER_32K    (*(volatile UInt32 *)0x6AE04030)
 
 /* turn on/off printf's */
 #define CHATTER 0
 
-#define HEAPID                      0u
-
 extern UInt32 gUtils_startLoadCalc;
 extern UInt32 gUtils_LoadLogInterval;
 
@@ -104,10 +72,19 @@ extern UInt32 gUtils_LoadLogInterval;
 
 /* MxServer skel function declarations */
 static Int32 MxServer_skel_compute(UInt32 size, UInt32 *data);
+static Int32 MxServer_skel_bench(UInt32 size, UInt32 *data);
 
-/* MxServer skel function array */
+/* MxServer skel function array, MxServer_bench<P> at index P */
 static RcmServer_FxnDesc mxSkelAry[] = {
-    { "MxServer_compute",       MxServer_skel_compute   }
+    { "MxServer_compute",       MxServer_skel_compute   },
+    { "MxServer_bench1",        MxServer_skel_bench     },
+    { "MxServer_bench2",        MxServer_skel_bench     },
+    { "MxServer_bench3",        MxServer_skel_bench     },
+    { "MxServer_bench4",        MxServer_skel_bench     },
+    { "MxServer_bench5",        MxServer_skel_bench     },
+    { "MxServer_bench6",        MxServer_skel_bench     },
+    { "MxServer_bench7",        MxServer_skel_bench     },
+    { "MxServer_bench8",        MxServer_skel_bench     }
 };
 
 /* MxServer skel function table */
@@ -116,13 +93,28 @@ static const RcmServer_FxnDescAry rpc_fxnTab = {
     mxSkelAry
 };
 
+#define MX_RET  { MmType_Dir_Out, MmType_Param_S32, 1 }
+#define MX_PTR  { MmType_Dir_In,  MmType_PtrType(MmType_Param_VOID), 1 }
+#define MX_U32  { MmType_Dir_In,  MmType_Param_U32, 1 }
+
 static MmType_FxnSig rpc_sigAry[] = {
     { "MxServer_compute", 2,
         {
             { MmType_Dir_Out, MmType_Param_S32, 1 }, /* return */
             { MmType_Dir_In,  MmType_PtrType(MmType_Param_VOID), 1 }
         }
-    }
+    },
+    { "MxServer_bench1", 2, { MX_RET, MX_PTR } },
+    { "MxServer_bench2", 3, { MX_RET, MX_PTR, MX_U32 } },
+    { "MxServer_bench3", 4, { MX_RET, MX_PTR, MX_U32, MX_U32 } },
+    { "MxServer_bench4", 5, { MX_RET, MX_PTR, MX_U32, MX_U32, MX_U32 } },
+    { "MxServer_bench5", 6, { MX_RET, MX_PTR, MX_U32, MX_U32, MX_U32, MX_U32 } },
+    { "MxServer_bench6", 7, { MX_RET, MX_PTR, MX_U32, MX_U32, MX_U32, MX_U32,
+                              MX_U32 } },
+    { "MxServer_bench7", 8, { MX_RET, MX_PTR, MX_U32, MX_U32, MX_U32, MX_U32,
+                              MX_U32, MX_U32 } },
+    { "MxServer_bench8", 9, { MX_RET, MX_PTR, MX_U32, MX_U32, MX_U32, MX_U32,
+                              MX_U32, MX_U32, MX_U32 } }
 };
 
 static MmType_FxnSigTab rpc_fxnSigTab = {
@@ -132,54 +124,108 @@ static MmType_FxnSigTab rpc_fxnSigTab = {
 /* the server create parameters, must be in persistent memory */
 static RcmServer_Params rpc_Params;
 
-#if defined(__cplusplus)
-extern "C" {
-#endif
-
-/*!
- *  @brief      Operation is successful
+/*
+ *  ======== mq_remote_os.h for SYS/BIOS ========
+ *  The IPU sees the host's buffers at their device addresses.
  */
-#define MxServer_S_SUCCESS (0)
+static Void MqOs_taskStub(UArg arg0, UArg arg1)
+{
+    ((MqOs_TaskFxn)arg0)((Void *)arg1);
+}
 
-/*!
- *  @brief      Operation failed
- */
-#define MxServer_E_FAIL (-1)
+MqOs_TaskHandle MqOs_taskCreate(MqOs_TaskFxn fxn, Void *arg)
+{
+    Task_Params params;
 
-/*!
- *  @brief      Compute structure
- */
-typedef struct {
-    int         size;
-    uint32_t *  inBuf;
-} MxServer_Compute;
-
-/*!
- *  @brief      Sample function which has pointer parameter to
- *              a structure with two embedded pointers.
- */
-int32_t MxServer_compute(MxServer_Compute *compute);
+    Task_Params_init(&params);
+    params.priority = 3;
+    params.arg0 = (UArg)fxn;
+    params.arg1 = (UArg)arg;
+    return (MqOs_TaskHandle)Task_create(MqOs_taskStub, &params, NULL);
+}
 
+Void MqOs_taskJoin(MqOs_TaskHandle task)
+{
+    Task_Handle handle = (Task_Handle)task;
 
-#if defined(__cplusplus)
+    while (Task_getMode(handle) != Task_Mode_TERMINATED) {
+        Task_sleep(1);
+    }
+    Task_delete(&handle);
 }
-#endif
 
-/*
- *  ======== MxServer_compute ========
- */
-int32_t MxServer_compute(MxServer_Compute *compute)
+Void MqOs_sleepUs(UInt32 usecs)
 {
-    int i;
+    /* whole ticks, rounded up */
+    Task_sleep((usecs + Clock_tickPeriod - 1) / Clock_tickPeriod);
+}
 
-    /* process inBuf ptr as data*/
-    for (i = 0; i < compute->size; i++) {
-        compute->inBuf[i] = 0xdeadbeef;
-    }
-    compute->inBuf[0] = (unsigned int)compute->inBuf;
-    return(0);
+UInt32 MqOs_timeUs(Void)
+{
+    return Clock_getTicks() * Clock_tickPeriod;
+}
+
+UInt32 MqOs_syncClock(Void)
+{
+    return SYNC_COUNTER_32K;
+}
+
+UInt32 MqOs_syncClockHz(Void)
+{
+    return 32768;
 }
 
+Void *MqOs_alloc(SizeT size)
+{
+    return Memory_calloc(NULL, size, 0, NULL);
+}
+
+Void MqOs_free(Void *ptr, SizeT size)
+{
+    Memory_free(NULL, ptr, size);
+}
+
+Void *MqOs_ptr(UInt32 devaddr)
+{
+    return (Void *)devaddr;
+}
+
+UInt32 MqOs_devaddr(Void *ptr)
+{
+    return (UInt32)ptr;
+}
+
+Void MqOs_cacheInv(Void *ptr, SizeT size)
+{
+    Cache_inv(ptr, size, Cache_Type_ALL, TRUE);
+}
+
+Void MqOs_cacheWb(Void *ptr, SizeT size)
+{
+    Cache_wb(ptr, size, Cache_Type_ALL, TRUE);
+}
+
+Void MqOs_abort(const Char *msg)
+{
+    System_abort((Char *)msg);
+}
+
+Void MqOs_sessionStart(Void)
+{
+    /* Reset the Load figures at the start so that we are able to get accurate CPU Load profin for this instance of run */
+    Utils_prfLoadCalcReset();
+    /*
+     * Time to sleep between load reporting attempts, in ticks.
+     * On TI platforms, 1 tick == 1 ms.
+     */
+    gUtils_LoadLogInterval = 500;
+    System_printf("Overall Starting Tic: %d\n", Clock_getTicks());
+}
+
+Void MqOs_sessionEnd(Void)
+{
+    gUtils_LoadLogInterval = 5000;
+}
 
 Void RPC_SKEL_SrvDelNotification(Void)
 {
@@ -212,6 +258,22 @@ Int32 MxServer_skel_compute(UInt32 size, UInt32 *data)
     return(result);
 }
 
+/*
+ *  ======== MxServer_skel_bench ========
+ *  The bench structure, then the scalars of MxServer_bench<P>.
+ */
+Int32 MxServer_skel_bench(UInt32 size, UInt32 *data)
+{
+    MmType_Param *payload = (MmType_Param *)data;
+    UInt32 num = size / sizeof(MmType_Param);
+    UInt32 i, scalars = 0;
+
+    for (i = 1; i < num; i++) {
+        scalars += (UInt32)payload[i].data;
+    }
+    return MxServer_bench((MxServer_Bench *)payload[0].data, scalars);
+}
+
 /*
  *  ======== register_MxServer ========
  *
@@ -254,383 +316,20 @@ leave:
     System_printf("register_MxServer: <--, status=%d\n", status);
 }
 
-Void dataTransactFxn(Void)
-{
-    MessageQ_Msg     getMsgData;
-    MessageQ_Handle  messageQData;
-    MessageQ_QueueId remoteQueueIdData;
-    Int              status,i;
-    Char             localQueueName[64];
-    Char             hostQueueName[64];
-    //UInt32 startC;
-    //UInt32 endC;
-    UInt32 *handshake_params;
-    UInt32 *boBufPayloadPtr, boBufPayloadSize;
-
-    System_printf("dataTransactFxn:\n");
-
-    System_sprintf(localQueueName, "%s_%d", SLAVE_MESSAGEQNAME, 0);
-    System_sprintf(hostQueueName,  "%s_%d", HOST_MESSAGEQNAME,  0);
-
-    /* Create a message queue. */
-    messageQData = MessageQ_create(localQueueName, NULL);
-    if (messageQData == NULL) {
-        System_abort("MessageQ_create failed\n");
-    }
-
-    System_printf("dataTransactFxn: created MessageQ: %s; QueueID: 0x%x\n",
-        localQueueName, MessageQ_getQueueId(messageQData));
-
-    //startC = Clock_getTicks();
-        /* Get a message */
-        status = MessageQ_get(messageQData, &getMsgData, MessageQ_FOREVER);
-        if (status != MessageQ_S_SUCCESS) {
-           System_abort("This should not happen since timeout is forever\n");
-        }
-        remoteQueueIdData = MessageQ_getReplyQueue(getMsgData);
-
-        handshake_params = MessageQ_payload(getMsgData);
-        boBufPayloadPtr = (UInt32 *)handshake_params[0];
-        boBufPayloadSize = handshake_params[1];
-#if CHATTER
-        System_printf("dataTransactFxn: Recvd boBufPayloadPtr:0x%x, boBufPayloadSize= %d, boBufPayloadPtr[0]=0x%x, boBufPayloadPtr[boBufPayloadSize-4]=0x%x\n",
-        boBufPayloadPtr,
-        boBufPayloadSize,
-        boBufPayloadPtr[0],
-        boBufPayloadPtr[(boBufPayloadSize/sizeof(uint32_t))-1]);
-#endif
-
-       for (i = 0; i < (boBufPayloadSize/sizeof(uint32_t)); i++) {
-              if(boBufPayloadPtr[i] != 0xbeefdead) {
-              status = 1;
-              System_printf("Data integrity failure!\n"
-                "    Expected %s\n"
-                "    Received 0x%x\n",
-                "0xbeefdead", boBufPayloadPtr[i]);
-              break;
-            }
-       }
-
-      for (i = 0; i < (boBufPayloadSize/sizeof(uint32_t)); i++) {
-       boBufPayloadPtr[i] = 0xdeadbeef;
-      }
-
-        /* test id of message received */
-        if (MessageQ_getMsgId(getMsgData) != 1) {
-            System_abort("The id received is incorrect!\n");
-        }
-
-        status = MessageQ_put(remoteQueueIdData, getMsgData);
-        if (status != MessageQ_S_SUCCESS) {
-           System_abort("MessageQ_put had a failure/error\n");
-        }
-    /*endC = Clock_getTicks();
-        System_printf("Thread %d: %d iterations took %d ticks or %d usecs/msg\n",
-                          arg0,numMsgs,
-            endC - startC, ((endC - startC) * Clock_tickPeriod) / numMsgs);*/
-
-    MessageQ_delete(&messageQData);
-}
-
-/*
- *  ======== loopbackFxn_Send========
- *  Receive and return messages.
- *  Run at priority lower than tsk1Fxn above.
- *  Inputs:
- *     - arg0: number of the thread, appended to MessageQ host and slave names.
- */
-Void loopbackFxn_Send(UArg arg0, UArg arg1)
-{
-    MessageQ_Msg     sndMsg;
-#if CHATTER
-    MessageQ_Handle  messageQ;
-    Char             localQueueName[64];
-    UInt32 *handshake_params;
-    UInt32 *boBufPayloadPtr, boBufPayloadSize;
-#endif
-    MessageQ_QueueId HostQueueId;
-    Char             hostQueueName[64];
-    Int              status;
-    UInt32           msgId = 0;
-    UInt32 startC;
-    UInt32 endC;
-    struct SyncMsg *thisTask = (struct SyncMsg *)arg0;
-
-#if CHATTER
-    System_printf("Thread loopbackFxn: %d\n", thisTask->numThread);
-#endif
-    System_sprintf(hostQueueName,  "%s_RECV_MQ_%d", A15_MESSAGEQNAME,  thisTask->numThread);
-#if CHATTER
-    System_printf("loopbackFxn: created MessageQ: %s; QueueID: 0x%x\n",
-        localQueueName, MessageQ_getQueueId(messageQ));
-    System_printf("Start the main loop: %d\n", thisTask->numThread);
-#endif
-    /* Poll until remote side has it's messageQ created before we send: */
-    do {
-        status = MessageQ_open (hostQueueName, &HostQueueId);
-        Task_sleep(1000);
-    } while (status == MessageQ_E_NOTFOUND);
-    if (status < 0) {
-        System_printf ("Error in MessageQ_open [0x%x]\n", status);
-    }
-
-    startC = Clock_getTicks();
-    while (msgId < thisTask->numMessages) {
-        sndMsg = MessageQ_alloc (HEAPID, sizeof(RemoteBufSyncMsg));
-        if (sndMsg == NULL) {
-            System_printf ("Error in MessageQ_alloc\n");
-            break;
-        }
-
-        MessageQ_setMsgId (sndMsg, msgId);
-
-        /* Have the remote proc reply to this message queue */
-      ((RemoteBufSyncMsg *)sndMsg)->boBufPayloadPtr =  (unsigned int *)thisTask->boBufPayloadPtr;
-      ((RemoteBufSyncMsg *)sndMsg)->boBufPayloadSize =  thisTask->boBufPayloadSize;
-
-        /* Send it back */
-        status = MessageQ_put(HostQueueId, sndMsg);
-        if (status != MessageQ_S_SUCCESS) {
-           System_abort("MessageQ_put had a failure/error\n");
-        }
-        msgId++;
-        Task_sleep((thisTask->numWaitTime/1000)+ ((thisTask->numWaitTime % 1000) != 0 )); /* Convert the receievd value which is in us to ms */
-    }
-
-    endC = Clock_getTicks();
-    System_printf("Thread %d: End Tic: %d\n",thisTask->numThread,endC);
-    System_printf("Thread %d: %d iterations took %d ticks or %d usecs/msg\n",
-                          thisTask->numThread, thisTask->numMessages,
-            endC - startC, ((endC - startC) * Clock_tickPeriod) /  thisTask->numMessages);
-
-#if CHATTER
-    System_printf("Test thread %d complete!\n", thisTask->numThread);
-#endif
-    MessageQ_close(&HostQueueId);
-
-    gFinishedCounter++;
-}
-
-/*
- *  ======== loopbackFxn_Recv========
- *  Receive and return messages.
- *  Run at priority lower than tsk1Fxn above.
- *  Inputs:
- *     - arg0: number of the thread, appended to MessageQ host and slave names.
- */
-Void loopbackFxn_Recv(UArg arg0, UArg arg1)
-{
-    MessageQ_Msg     getMsg;
-    MessageQ_Handle  messageQ;
-    Int              status;
-    UInt32           msgId = 0;
-    Char             localQueueName[64];
-    UInt32 startC;
-    UInt32 endC;
-    struct SyncMsg *thisTask = (struct SyncMsg *)arg0;
-
-#if CHATTER
-    UInt32 *handshake_params;
-    UInt32 *boBufPayloadPtr, boBufPayloadSize;
-    System_printf("Thread loopbackFxn_Recv: %d\n", thisTask->numThread);
-#endif
-    System_sprintf(localQueueName, "%s_RECV_MQ_%d", M4_MESSAGEQNAME, thisTask->numThread);
-#if CHATTER
-    System_printf("Thread loopbackFxn_Recv: %d from Name:%s\n", thisTask->numThread,localQueueName);
-#endif
-    /* Create a message queue. */
-    messageQ = MessageQ_create(localQueueName, NULL);
-    if (messageQ == NULL) {
-        System_abort("MessageQ_create failed\n");
-    }
-
-#if CHATTER
-    System_printf("loopbackFxn_Recv: created MessageQ: %s; QueueID: 0x%x\n",
-        localQueueName, MessageQ_getQueueId(messageQ));
-    System_printf("Start the main loop: %d\n", thisTask->numThread)
-#endif
-    startC = Clock_getTicks();
-
-    while (msgId < thisTask->numMessages) {
-        /* Get a message */
-        status = MessageQ_get(messageQ, &getMsg, MessageQ_FOREVER);
-        if (status != MessageQ_S_SUCCESS) {
-           System_abort("This should not happen since timeout is forever\n");
-        }
-
-#if CHATTER
-        handshake_params = MessageQ_payload(getMsg);
-        boBufPayloadPtr = (UInt32 *)handshake_params[0];
-        boBufPayloadSize = handshake_params[1];
-        System_printf("Recvd boBufPayloadPtr:0x%x, boBufPayloadSize= %d, boBufPayloadPtr[0]=0x%x, boBufPayloadPtr[boBufPayloadSize-4]=0x%x\n",
-        boBufPayloadPtr,
-        boBufPayloadSize,
-        boBufPayloadPtr[0],
-        boBufPayloadPtr[boBufPayloadSize-1]);
-#endif
-        /* test id of message received */
-        if (MessageQ_getMsgId(getMsg) != msgId) {
-            System_abort("The id received is incorrect!\n");
-        }
-        status = MessageQ_free (getMsg);
-        msgId++;
-    }
-
-    endC = Clock_getTicks();
-    System_printf("Thread %d: End Tic: %d\n",thisTask->numThread,endC);
-    System_printf("Thread %d: %d iterations took %d ticks or %d usecs/msg\n",
-                          thisTask->numThread,thisTask->numMessages,
-            endC - startC, ((endC - startC) * Clock_tickPeriod) / thisTask->numMessages);
-
-    MessageQ_delete(&messageQ);
-#if CHATTER
-    System_printf("Test thread %d complete!\n", thisTask->numThread);
-#endif
-
-    gFinishedCounter++;
-}
-
 Void tsk1Fxn(UArg arg0, UArg arg1)
 {
-    MessageQ_Msg msg;
-    MessageQ_Handle  messageQ;
-    MessageQ_QueueId remoteQueueId;
-    Char             localQueueName[64];
-    Char             tempTaskName[64];
-    UInt32 *handshake_params;
-    Task_Params params;
-    Int i, status;
-    struct SyncMsg *pTaskConfigs = NULL;
-
     gUtils_startLoadCalc = 1;
-   /* Create handshake thread to correspond with host side test app: */
-    while(1)
-    {
-               #if 1
-               gFinishedCounter = 0;
-	       Task_sleep(2000);
-	       Utils_prfLoadCalcReset();
-
-               /* Construct a MessageQ name adorned with core name: */
-               System_sprintf(localQueueName, "%s_%s", SLAVE_MESSAGEQNAME,
-                                          MultiProc_getName(MultiProc_self()));
-
-               messageQ = MessageQ_create(localQueueName, NULL);
-               if (messageQ == NULL) {
-                       System_abort("MessageQ_create failed\n");
-               }
-
-               System_printf("tsk1Fxn: created MessageQ: %s; QueueID: 0x%x\n",
-               localQueueName, MessageQ_getQueueId(messageQ));
-
-               /* handshake with host to get starting parameters */
-               System_printf("Awaiting handshake sync message from host...\n");
-
-	       MessageQ_get(messageQ, &msg, MessageQ_FOREVER);
-
-	       /* Reset the Load figures at the start so that we are able to get accurate CPU Load profin for this instance of run */
-	       Utils_prfLoadCalcReset();
-
-               handshake_params = MessageQ_payload(msg); 
-               numThreads = handshake_params[2];
-               remoteQueueId = MessageQ_getReplyQueue(msg);
-
-	       status = MessageQ_put(remoteQueueId, msg);
-	       if (status != MessageQ_S_SUCCESS) {
-        	 System_abort("MessageQ_put had a failure/error\n");
-	       }
-
-	       pTaskConfigs = (struct SyncMsg *)Memory_alloc(NULL, (numThreads * sizeof(struct SyncMsg)), 0, NULL);
-		/*
-		 * Time to sleep between load reporting attempts, in ticks.
-		 * On TI platforms, 1 tick == 1 ms.
-		 */
-               gUtils_LoadLogInterval = 500;
-               for(i=0; i<numThreads;i++)
-               {
-
-	        	MessageQ_get(messageQ, &msg, MessageQ_FOREVER);
-			handshake_params = MessageQ_payload(msg);
-	                pTaskConfigs[i].numThread = i;
-			pTaskConfigs[i].numMessages = handshake_params[3];
-	                pTaskConfigs[i].numWaitTime = handshake_params[4];
- 	                pTaskConfigs[i].payloadSize = handshake_params[5];
-
-                 	pTaskConfigs[i].boBufPayloadPtr = (UInt32)handshake_params[0];
-                	pTaskConfigs[i].boBufPayloadSize = handshake_params[1];
-
-	                if(handshake_params[7] == unidirectional_recv)
-         		{
-		                pTaskConfigs[i].thrDirection = unidirectional_send;
-	                }
-        	        else if (handshake_params[7] == unidirectional_send)
-                 	{
-				pTaskConfigs[i].thrDirection = unidirectional_recv;
-                   	}	
-
-               	       remoteQueueId = MessageQ_getReplyQueue(msg);
-#if CHATTER
-	               System_printf("Received handshake msg from (procId:remoteQueueId): 0x%x:0x%x\n"
-                       "Threads:%d Direction:%d messages: %d Wait Time(in us):%d payload: %d bytes, boBufPayloadPtr:%x, boBufPayloadSize:%d\n",
-                       MessageQ_getProcId(remoteQueueId), remoteQueueId,
-                       i,
-                       pTaskConfigs[i].thrDirection,
-                       pTaskConfigs[i].numMessages,
-                       pTaskConfigs[i].numWaitTime,
-                       pTaskConfigs[i].payloadSize,
-		       pTaskConfigs[i].boBufPayloadPtr,
-		       pTaskConfigs[i].boBufPayloadSize);
-#endif
-	   	       status = MessageQ_put(remoteQueueId, msg);
-	               if (status != MessageQ_S_SUCCESS) {
-        		         System_abort("MessageQ_put had a failure/error\n");
-               		}
-
-		}
-
-               MessageQ_delete(&messageQ);
-
-                System_printf("Overall Starting Tic: %d\n",Clock_getTicks());
-                /* Create N threads to correspond with host side N thread test app: */
-        	Task_Params_init(&params);
-	        params.priority = 3;
-	        for (i = 0; i < numThreads; i++) {
-	               System_sprintf(tempTaskName, "MessageQ_Task_%d",i);
-                       if(pTaskConfigs[i].thrDirection == unidirectional_recv)
-                       {
-				params.arg0 = (unsigned int)&pTaskConfigs[i];
-				pTaskConfigs[i].thrId = Task_create(loopbackFxn_Recv, &params, NULL);
-				if( NULL == pTaskConfigs[i].thrId)
-				        System_printf("Task[%d]:Could not create %s task!\n",i,tempTaskName);
-	               }
-                       else if(pTaskConfigs[i].thrDirection == unidirectional_send)
-                       {
-				params.arg0 = (unsigned int)&pTaskConfigs[i];
-				pTaskConfigs[i].thrId =  Task_create(loopbackFxn_Send, &params, NULL);
-				if( NULL == pTaskConfigs[i].thrId)
-					System_printf("Task[%d]:Could not create %s task!\n",i,tempTaskName);
-                       }
-        	}
-
-        	while(gFinishedCounter < numThreads)
-        	{	
-           		Task_sleep(1000);    // sleep 1 second
-		}
-
-        dataTransactFxn();
-
-	for (i = 0; i < numThreads; i++) {
-		Task_delete(&pTaskConfigs[i].thrId);
-	}
-
-	Memory_free(NULL,pTaskConfigs, (numThreads * sizeof(struct SyncMsg)));
-
-	gUtils_LoadLogInterval = 5000;
-        #endif
+    MqRemote_init();
+
+    /* Serve one host run after the other */
+    while (1) {
+        Task_sleep(2000);
+        Utils_prfLoadCalcReset();
+
+        MqRemote_session();
     }
 }
 
-
 Void mmrpc_tsk1Fxn(UArg arg0, UArg arg1)
 {
     register_MxServer();
@@ -0,0 +1,734 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== mq_remote.c ========
+ *
+ *  Remote side logic of the MessageQ zero copy test, shared by the IPU
+ *  firmware and the host loopback build.
+ */
+
+#include <string.h>
+
+#include "mq_remote.h"
+
+#define MessageQ_payload(m) ((void *)((char *)(m) + sizeof(MessageQ_MsgHeader)))
+#define MSG_INLINE(m)       ((void *)((char *)(m) + sizeof(RemoteBufSyncMsg)))
+
+/* turn on/off printf's */
+#define CHATTER 0
+
+#define HEAPID                      0u
+
+typedef struct SyncMsg {
+    unsigned int boBufPayloadPtr; /*Shared Region pointer address to be exchanged using MessageQ*/
+    unsigned int boBufPayloadSize; /*Shared Region pointer address  Size*/
+    unsigned int numThread; /* Indicates the number of threads to the other core: Handshake */
+    unsigned int numMessages; /* Indicates the number of messages: Handshake */
+    unsigned int numWaitTime; /* Indicates the sleep/wait between send messages: Handshake */
+    unsigned int payloadSize; /* Indicates the size of the payload which will be carried by each message: Handshake */
+    unsigned int procId; /* Core the stream talks to */
+    unsigned int thrDirection; /* As seen from this side */
+    unsigned int poolSize; /* Messages preallocated by the sender of this stream, 0 = alloc per message */
+    unsigned int batch; /* Messages put per wakeup */
+    unsigned int slots; /* Buffer ring depth, message k of the pool owns slot k */
+    unsigned int check; /* Payloads carry a seeded pattern and its CRC32C */
+    unsigned int copy; /* CopyMode */
+    MqOs_TaskHandle thrId;
+ } SyncMsg;
+
+/*
+ * Log-linear histogram of one-way latencies in sync counter ticks: each
+ * power of two is split into LAT_SUB linear buckets.
+ */
+#define LAT_SUB_BITS    4
+#define LAT_SUB         (1 << LAT_SUB_BITS)
+#define LAT_BUCKETS     ((32 - LAT_SUB_BITS + 1) * LAT_SUB)
+
+typedef struct LatHist {
+    UInt32 count;
+    UInt32 max;
+    UInt32 bucket[LAT_BUCKETS];
+} LatHist;
+
+static Void latHist_add(LatHist *h, UInt32 ticks)
+{
+    UInt32 shift = 0;
+
+    while ((ticks >> shift) >= 2 * LAT_SUB) {
+        shift++;
+    }
+    if (ticks < LAT_SUB) {
+        h->bucket[ticks]++;
+    }
+    else {
+        h->bucket[((shift + 1) << LAT_SUB_BITS) + ((ticks >> shift) & (LAT_SUB - 1))]++;
+    }
+    h->count++;
+    if (ticks > h->max) {
+        h->max = ticks;
+    }
+}
+
+/* Upper bound of the bucket holding the permille percentile, in usecs */
+static UInt32 latHist_percentile(LatHist *h, UInt32 permille)
+{
+    UInt32 rank = (h->count * permille + 999) / 1000;
+    UInt32 seen = 0, i, shift, ticks = h->max;
+
+    for (i = 0; i < LAT_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen >= rank && seen > 0) {
+            if (i < LAT_SUB) {
+                ticks = i;
+            }
+            else {
+                shift = (i >> LAT_SUB_BITS) - 1;
+                ticks = ((LAT_SUB + (i & (LAT_SUB - 1))) << shift) + (1 << shift) - 1;
+            }
+            break;
+        }
+    }
+    if (ticks > h->max) {
+        ticks = h->max;
+    }
+    return (UInt32)(((unsigned long long)ticks * 1000000) / MqOs_syncClockHz());
+}
+
+/*
+ * Payload check (check=1 on the host): the sender fills the slot with the
+ * message id in the first and last word and an xorshift32 pattern seeded
+ * by stream and message id in between, and sends the CRC32C along. Must
+ * match crc32c.c of the host application, which is a separate
+ * implementation on purpose.
+ */
+static UInt32 crcTable[256];
+
+static Void crc32c_init(Void)
+{
+    UInt32 crc, i, j;
+
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+        }
+        crcTable[i] = crc;
+    }
+}
+
+static inline UInt32 crc32c_u32(UInt32 crc, UInt32 word)
+{
+    crc ^= word;
+    crc = (crc >> 8) ^ crcTable[crc & 0xFF];
+    crc = (crc >> 8) ^ crcTable[crc & 0xFF];
+    crc = (crc >> 8) ^ crcTable[crc & 0xFF];
+    return (crc >> 8) ^ crcTable[crc & 0xFF];
+}
+
+static UInt32 payload_seed(UInt32 thread, UInt32 msgId)
+{
+    UInt32 seed = ((thread << 16) ^ (msgId & 0xFFFF) ^ (msgId >> 16)) * 0x9E3779B1;
+
+    return seed ? seed : 1;
+}
+
+static UInt32 payload_fill(UInt32 *p, UInt32 words, UInt32 seed, UInt32 tag)
+{
+    UInt32 crc = 0xFFFFFFFF, x = seed, i;
+
+    p[0] = tag;
+    crc = crc32c_u32(crc, tag);
+    for (i = 1; i + 1 < words; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        p[i] = x;
+        crc = crc32c_u32(crc, x);
+    }
+    if (words > 1) {
+        p[words - 1] = tag;
+        crc = crc32c_u32(crc, tag);
+    }
+    return ~crc;
+}
+
+static UInt32 payload_crc(const UInt32 *p, UInt32 words)
+{
+    UInt32 crc = 0xFFFFFFFF, i;
+
+    for (i = 0; i < words; i++) {
+        crc = crc32c_u32(crc, p[i]);
+    }
+    return ~crc;
+}
+
+/* Messages of the stream carry the payload too with COPY_INLINE */
+static UInt32 msg_size(const SyncMsg *task)
+{
+    return sizeof(RemoteBufSyncMsg) + (task->copy == COPY_INLINE ? task->payloadSize : 0);
+}
+
+/* Private end of a copy path, NULL without one */
+static Void *copy_buf(const SyncMsg *task)
+{
+    Void *buf;
+
+    if (task->copy == COPY_NONE) {
+        return NULL;
+    }
+    buf = MqOs_alloc(task->payloadSize ? task->payloadSize : 1);
+    if (buf == NULL) {
+        MqOs_abort("MqOs_alloc failed for the copy buffer\n");
+    }
+    return buf;
+}
+
+/*
+ *  ======== MxServer_compute ========
+ */
+int32_t MxServer_compute(MxServer_Compute *compute)
+{
+    int i;
+
+    /* process inBuf ptr as data*/
+    for (i = 0; i < compute->size; i++) {
+        compute->inBuf[i] = 0xdeadbeef;
+    }
+    compute->inBuf[0] = MqOs_devaddr(compute->inBuf);
+    return(0);
+}
+
+/*
+ *  ======== MxServer_bench ========
+ */
+int32_t MxServer_bench(MxServer_Bench *bench, uint32_t scalars)
+{
+    uint32_t sum = scalars, *buf;
+    uint32_t i, k;
+
+    MqOs_cacheInv(bench, sizeof(*bench));
+    for (k = 0; k < bench->numBufs && k < MX_BENCH_MAX_XLTS; k++) {
+        buf = bench->buf[k];
+        MqOs_cacheInv(buf, bench->size);
+        for (i = 0; i < bench->size / sizeof(uint32_t); i++) {
+            sum += buf[i];
+        }
+    }
+    return (int32_t)sum;
+}
+
+static Void dataTransactFxn(Void)
+{
+    MessageQ_Msg     getMsgData;
+    MessageQ_Handle  messageQData;
+    MessageQ_QueueId remoteQueueIdData;
+    Int              status;
+    UInt32           i;
+    Char             localQueueName[64];
+    UInt32 *handshake_params;
+    UInt32 *boBufPayloadPtr, boBufPayloadSize;
+
+    MqOs_printf("dataTransactFxn:\n");
+
+    MqOs_sprintf(localQueueName, "%s_%d", SLAVE_MESSAGEQNAME, 0);
+
+    /* Create a message queue. */
+    messageQData = MessageQ_create(localQueueName, NULL);
+    if (messageQData == NULL) {
+        MqOs_abort("MessageQ_create failed\n");
+    }
+
+#if CHATTER
+    MqOs_printf("dataTransactFxn: created MessageQ: %s; QueueID: 0x%x\n",
+        localQueueName, MessageQ_getQueueId(messageQData));
+#endif
+
+    /* Get a message */
+    status = MessageQ_get(messageQData, &getMsgData, MessageQ_FOREVER);
+    if (status != MessageQ_S_SUCCESS) {
+        MqOs_abort("This should not happen since timeout is forever\n");
+    }
+    remoteQueueIdData = MessageQ_getReplyQueue(getMsgData);
+
+    handshake_params = MessageQ_payload(getMsgData);
+    boBufPayloadPtr = MqOs_ptr(handshake_params[0]);
+    boBufPayloadSize = handshake_params[1];
+
+    MqOs_cacheInv(boBufPayloadPtr, boBufPayloadSize);
+    for (i = 0; i < (boBufPayloadSize/sizeof(uint32_t)); i++) {
+        if (boBufPayloadPtr[i] != 0xbeefdead) {
+            MqOs_printf("Data integrity failure!\n"
+                "    Expected %s\n"
+                "    Received 0x%x\n",
+                "0xbeefdead", boBufPayloadPtr[i]);
+            break;
+        }
+    }
+
+    for (i = 0; i < (boBufPayloadSize/sizeof(uint32_t)); i++) {
+        boBufPayloadPtr[i] = 0xdeadbeef;
+    }
+    MqOs_cacheWb(boBufPayloadPtr, boBufPayloadSize);
+
+    /* test id of message received */
+    if (MessageQ_getMsgId(getMsgData) != 1) {
+        MqOs_abort("The id received is incorrect!\n");
+    }
+
+    status = MessageQ_put(remoteQueueIdData, getMsgData);
+    if (status != MessageQ_S_SUCCESS) {
+        MqOs_abort("MessageQ_put had a failure/error\n");
+    }
+
+    MessageQ_delete(&messageQData);
+}
+
+/*
+ *  ======== loopbackFxn_Send========
+ *  Send numMessages to the host thread of the stream, batch messages
+ *  per wakeup, batch * interval apart.
+ */
+static Void loopbackFxn_Send(Void *arg)
+{
+    MessageQ_Msg     sndMsg;
+    MessageQ_QueueId HostQueueId;
+    Char             hostQueueName[64];
+    Char             poolQueueName[64];
+    Int              status;
+    UInt32           msgId = 0;
+    UInt32           start, elapsed;
+    SyncMsg         *thisTask = (SyncMsg *)arg;
+    MessageQ_Handle  poolQ = NULL;
+    MessageQ_Msg    *pool = NULL;
+    UInt32           poolFree = 0, poolExhausted = 0, i;
+    UInt32          *slot;
+    Void            *copyBuf = copy_buf(thisTask);
+
+    MqOs_sprintf(hostQueueName,  "%s_RECV_MQ_%d", A15_MESSAGEQNAME,  thisTask->numThread);
+
+    /* Poll until remote side has it's messageQ created before we send: */
+    while ((status = MessageQ_open (hostQueueName, &HostQueueId)) == MessageQ_E_NOTFOUND) {
+        MqOs_sleepUs(1000);
+    }
+    if (status < 0) {
+        MqOs_abort("MessageQ_open failed\n");
+    }
+
+    /*
+     * Pooled mode: allocate the messages once, the host puts each one back
+     * to poolQ after reading it.
+     */
+    if (thisTask->poolSize) {
+        MqOs_sprintf(poolQueueName, "%s_POOL_%d", M4_MESSAGEQNAME, thisTask->numThread);
+        poolQ = MessageQ_create(poolQueueName, NULL);
+        pool = MqOs_alloc(thisTask->poolSize * sizeof(MessageQ_Msg));
+        if (poolQ == NULL || pool == NULL) {
+            MqOs_abort("Message pool creation failed\n");
+        }
+        for (poolFree = 0; poolFree < thisTask->poolSize; poolFree++) {
+            pool[poolFree] = MessageQ_alloc (HEAPID, msg_size(thisTask));
+            if (pool[poolFree] == NULL) {
+                MqOs_abort("MessageQ_alloc failed for the message pool\n");
+            }
+            MessageQ_setReplyQueue(poolQ, pool[poolFree]);
+            if (thisTask->slots) {
+                /* the message is the credit for its slot */
+                ((RemoteBufSyncMsg *)pool[poolFree])->boBufPayloadPtr =
+                    thisTask->boBufPayloadPtr + poolFree * thisTask->payloadSize;
+                ((RemoteBufSyncMsg *)pool[poolFree])->boBufPayloadSize = thisTask->payloadSize;
+            }
+        }
+    }
+
+    start = MqOs_timeUs();
+    while (msgId < thisTask->numMessages) {
+        if (pool != NULL) {
+            while (poolFree < thisTask->poolSize &&
+                   MessageQ_get(poolQ, &pool[poolFree], 0) == MessageQ_S_SUCCESS) {
+                poolFree++;
+            }
+            if (poolFree == 0) {
+                poolExhausted++;
+                if (MessageQ_get(poolQ, &pool[poolFree++], MessageQ_FOREVER) < 0) {
+                    MqOs_abort("MessageQ_get failed\n");
+                }
+            }
+            sndMsg = pool[--poolFree];
+        }
+        else {
+            sndMsg = MessageQ_alloc (HEAPID, msg_size(thisTask));
+        }
+        if (sndMsg == NULL) {
+            MqOs_abort("MessageQ_alloc failed\n");
+        }
+
+        MessageQ_setMsgId (sndMsg, msgId);
+
+        if (thisTask->check) {
+            slot = MqOs_ptr(((RemoteBufSyncMsg *)sndMsg)->boBufPayloadPtr);
+            ((RemoteBufSyncMsg *)sndMsg)->crc =
+                payload_fill(slot, thisTask->payloadSize / sizeof(UInt32),
+                             payload_seed(thisTask->numThread, msgId), msgId);
+            MqOs_cacheWb(slot, thisTask->payloadSize);
+        }
+        else if (thisTask->slots) {
+            /* the slot came back with its message, tag it for the host */
+            slot = MqOs_ptr(((RemoteBufSyncMsg *)sndMsg)->boBufPayloadPtr);
+            slot[0] = msgId;
+            slot[thisTask->payloadSize / sizeof(UInt32) - 1] = msgId;
+            MqOs_cacheWb(slot, sizeof(UInt32));
+            MqOs_cacheWb(&slot[thisTask->payloadSize / sizeof(UInt32) - 1], sizeof(UInt32));
+        }
+        else {
+            ((RemoteBufSyncMsg *)sndMsg)->boBufPayloadPtr = thisTask->boBufPayloadPtr;
+            ((RemoteBufSyncMsg *)sndMsg)->boBufPayloadSize = thisTask->boBufPayloadSize;
+        }
+        if (thisTask->copy == COPY_INLINE) {
+            memcpy(MSG_INLINE(sndMsg), copyBuf, thisTask->payloadSize);
+        }
+        else if (thisTask->copy == COPY_BO) {
+            slot = MqOs_ptr(thisTask->boBufPayloadPtr);
+            memcpy(slot, copyBuf, thisTask->payloadSize);
+            MqOs_cacheWb(slot, thisTask->payloadSize);
+        }
+        ((RemoteBufSyncMsg *)sndMsg)->recvTs = 0;
+        ((RemoteBufSyncMsg *)sndMsg)->sendTs = MqOs_syncClock();
+
+        status = MessageQ_put(HostQueueId, sndMsg);
+        if (status != MessageQ_S_SUCCESS) {
+            MqOs_abort("MessageQ_put had a failure/error\n");
+        }
+        msgId++;
+        /* a batch of messages per wakeup, batch * interval apart */
+        if (thisTask->numWaitTime && (msgId % thisTask->batch) == 0) {
+            MqOs_sleepUs(thisTask->numWaitTime * thisTask->batch);
+        }
+    }
+
+    elapsed = MqOs_timeUs() - start;
+    MqOs_printf("Thread %d: %d iterations took %d usecs or %d usecs/msg\n",
+                thisTask->numThread, thisTask->numMessages, elapsed,
+                thisTask->numMessages ? elapsed / thisTask->numMessages : 0);
+
+    if (pool != NULL) {
+        MqOs_printf("Thread %d: pool of %d msgs exhausted %d times\n",
+                    thisTask->numThread, thisTask->poolSize, poolExhausted);
+
+        /* Wait for the messages still in flight, then release the pool */
+        while (poolFree < thisTask->poolSize) {
+            if (MessageQ_get(poolQ, &pool[poolFree++], MessageQ_FOREVER) < 0) {
+                MqOs_abort("MessageQ_get failed\n");
+            }
+        }
+        for (i = 0; i < thisTask->poolSize; i++) {
+            MessageQ_free(pool[i]);
+        }
+        MqOs_free(pool, thisTask->poolSize * sizeof(MessageQ_Msg));
+        MessageQ_delete(&poolQ);
+    }
+    if (copyBuf != NULL) {
+        MqOs_free(copyBuf, thisTask->payloadSize ? thisTask->payloadSize : 1);
+    }
+
+    MessageQ_close(&HostQueueId);
+}
+
+/*
+ *  ======== loopbackFxn_Recv========
+ *  Receive numMessages from the host thread of the stream, check them
+ *  and return or free each one.
+ */
+static Void loopbackFxn_Recv(Void *arg)
+{
+    MessageQ_Msg     getMsg;
+    MessageQ_Handle  messageQ;
+    MessageQ_QueueId returnQueueId;
+    Int              status;
+    UInt32           msgId = 0;
+    Char             localQueueName[64];
+    UInt32           start, elapsed;
+    SyncMsg         *thisTask = (SyncMsg *)arg;
+    LatHist         *latency;
+    UInt32 *slot, slotErrors = 0, crcErrors = 0;
+    Void            *copyBuf = copy_buf(thisTask);
+
+    MqOs_sprintf(localQueueName, "%s_RECV_MQ_%d", M4_MESSAGEQNAME, thisTask->numThread);
+
+    /* Create a message queue. */
+    messageQ = MessageQ_create(localQueueName, NULL);
+    if (messageQ == NULL) {
+        MqOs_abort("MessageQ_create failed\n");
+    }
+
+    latency = MqOs_alloc(sizeof(LatHist));
+    if (latency == NULL) {
+        MqOs_abort("MqOs_alloc failed\n");
+    }
+
+    start = MqOs_timeUs();
+
+    while (msgId < thisTask->numMessages) {
+        /* Get a message */
+        status = MessageQ_get(messageQ, &getMsg, MessageQ_FOREVER);
+        if (status != MessageQ_S_SUCCESS) {
+            MqOs_abort("This should not happen since timeout is forever\n");
+        }
+        ((RemoteBufSyncMsg *)getMsg)->recvTs = MqOs_syncClock();
+        latHist_add(latency, ((RemoteBufSyncMsg *)getMsg)->recvTs -
+                             ((RemoteBufSyncMsg *)getMsg)->sendTs);
+
+        /* test id of message received */
+        if (MessageQ_getMsgId(getMsg) != (msgId & 0xFFFF)) {
+            MqOs_abort("The id received is incorrect!\n");
+        }
+
+        if (thisTask->check) {
+            slot = MqOs_ptr(((RemoteBufSyncMsg *)getMsg)->boBufPayloadPtr);
+            MqOs_cacheInv(slot, thisTask->payloadSize);
+            if (payload_crc(slot, thisTask->payloadSize / sizeof(UInt32)) !=
+                ((RemoteBufSyncMsg *)getMsg)->crc) {
+                crcErrors++;
+            }
+        }
+        /* Ring slots carry the message id in their first and last word */
+        if (thisTask->slots) {
+            slot = MqOs_ptr(((RemoteBufSyncMsg *)getMsg)->boBufPayloadPtr);
+            MqOs_cacheInv(slot, sizeof(UInt32));
+            MqOs_cacheInv(&slot[thisTask->payloadSize / sizeof(UInt32) - 1], sizeof(UInt32));
+            if (slot[0] != msgId ||
+                slot[thisTask->payloadSize / sizeof(UInt32) - 1] != msgId) {
+                slotErrors++;
+            }
+        }
+        if (thisTask->copy == COPY_INLINE) {
+            memcpy(copyBuf, MSG_INLINE(getMsg), thisTask->payloadSize);
+        }
+        else if (thisTask->copy == COPY_BO) {
+            slot = MqOs_ptr(((RemoteBufSyncMsg *)getMsg)->boBufPayloadPtr);
+            MqOs_cacheInv(slot, thisTask->payloadSize);
+            memcpy(copyBuf, slot, thisTask->payloadSize);
+        }
+
+        /* Pooled messages go back to the host, the others are freed */
+        returnQueueId = MessageQ_getReplyQueue(getMsg);
+        if (returnQueueId != MessageQ_INVALIDMESSAGEQ) {
+            status = MessageQ_put(returnQueueId, getMsg);
+        }
+        else {
+            status = MessageQ_free (getMsg);
+        }
+        msgId++;
+    }
+
+    elapsed = MqOs_timeUs() - start;
+    MqOs_printf("Thread %d: %d iterations took %d usecs or %d usecs/msg\n",
+                thisTask->numThread, thisTask->numMessages, elapsed,
+                thisTask->numMessages ? elapsed / thisTask->numMessages : 0);
+    MqOs_printf("Thread %d: one-way latency usecs p50 %d p99 %d p99.9 %d max %d\n",
+                thisTask->numThread,
+                latHist_percentile(latency, 500), latHist_percentile(latency, 990),
+                latHist_percentile(latency, 999), latHist_percentile(latency, 1000));
+    if (thisTask->slots) {
+        MqOs_printf("Thread %d: ring of %d slots, %d bad slot tags\n",
+                    thisTask->numThread, thisTask->slots, slotErrors);
+    }
+    if (thisTask->check) {
+        MqOs_printf("Thread %d: %d bad crc\n", thisTask->numThread, crcErrors);
+    }
+    MqOs_free(latency, sizeof(LatHist));
+    if (copyBuf != NULL) {
+        MqOs_free(copyBuf, thisTask->payloadSize ? thisTask->payloadSize : 1);
+    }
+
+    MessageQ_delete(&messageQ);
+}
+
+/*
+ *  ======== loopbackFxn_Echo========
+ *  Stamp and return every message to the host thread that sent it, for
+ *  the host's round trip (direction=2) mode.
+ */
+static Void loopbackFxn_Echo(Void *arg)
+{
+    MessageQ_Msg     getMsg;
+    MessageQ_Handle  messageQ;
+    Int              status;
+    UInt32           msgId = 0;
+    Char             localQueueName[64];
+    SyncMsg         *thisTask = (SyncMsg *)arg;
+
+    MqOs_sprintf(localQueueName, "%s_PING_MQ_%d", M4_MESSAGEQNAME, thisTask->numThread);
+    messageQ = MessageQ_create(localQueueName, NULL);
+    if (messageQ == NULL) {
+        MqOs_abort("MessageQ_create failed\n");
+    }
+
+    while (msgId < thisTask->numMessages) {
+        status = MessageQ_get(messageQ, &getMsg, MessageQ_FOREVER);
+        if (status != MessageQ_S_SUCCESS) {
+            MqOs_abort("This should not happen since timeout is forever\n");
+        }
+        ((RemoteBufSyncMsg *)getMsg)->recvTs = MqOs_syncClock();
+
+        status = MessageQ_put(MessageQ_getReplyQueue(getMsg), getMsg);
+        if (status != MessageQ_S_SUCCESS) {
+            MqOs_abort("MessageQ_put had a failure/error\n");
+        }
+        msgId++;
+    }
+
+    MqOs_printf("Thread %d: echoed %d messages\n", thisTask->numThread, msgId);
+    MessageQ_delete(&messageQ);
+}
+
+Void MqRemote_init(Void)
+{
+    crc32c_init();
+}
+
+Int MqRemote_session(Void)
+{
+    MessageQ_Msg msg;
+    MessageQ_Handle  messageQ;
+    MessageQ_QueueId remoteQueueId;
+    Char             localQueueName[64];
+    UInt32 *handshake_params;
+    UInt32 i, numThreads;
+    Int status;
+    SyncMsg *pTaskConfigs = NULL;
+    StreamTable *table;
+    StreamDesc *desc;
+
+    /* Construct a MessageQ name adorned with core name: */
+    MqOs_sprintf(localQueueName, "%s_%s", SLAVE_MESSAGEQNAME,
+                 MultiProc_getName(MultiProc_self()));
+
+    messageQ = MessageQ_create(localQueueName, NULL);
+    if (messageQ == NULL) {
+        MqOs_abort("MessageQ_create failed\n");
+    }
+
+#if CHATTER
+    MqOs_printf("MqRemote_session: created MessageQ: %s; QueueID: 0x%x\n",
+                localQueueName, MessageQ_getQueueId(messageQ));
+#endif
+
+    /* handshake with host to get starting parameters */
+    MqOs_printf("Awaiting handshake sync message from host...\n");
+
+    if (MessageQ_get(messageQ, &msg, MessageQ_FOREVER) != MessageQ_S_SUCCESS) {
+        MessageQ_delete(&messageQ);
+        return -1;
+    }
+
+    MqOs_sessionStart();
+
+    /* [0] table address, [1] table size, [2] streams */
+    handshake_params = MessageQ_payload(msg);
+    table = MqOs_ptr(handshake_params[0]);
+    numThreads = handshake_params[2];
+    remoteQueueId = MessageQ_getReplyQueue(msg);
+
+    if (table == NULL) {
+        MqOs_abort("Bad stream table from host\n");
+    }
+    MqOs_cacheInv(table, handshake_params[1]);
+    if (table->magic != STREAM_TABLE_MAGIC || table->descSize != sizeof(StreamDesc) ||
+        table->numStreams != numThreads) {
+        MqOs_abort("Bad stream table from host\n");
+    }
+
+    pTaskConfigs = MqOs_alloc(numThreads * sizeof(SyncMsg));
+    if (pTaskConfigs == NULL) {
+        MqOs_abort("MqOs_alloc failed for the stream configs\n");
+    }
+
+    for (i = 0; i < numThreads; i++) {
+        desc = &table->stream[i];
+        pTaskConfigs[i].numThread = i;
+        pTaskConfigs[i].numMessages = desc->numMessages;
+        pTaskConfigs[i].numWaitTime = desc->numWaitTime;
+        pTaskConfigs[i].payloadSize = desc->payloadSize;
+        pTaskConfigs[i].boBufPayloadPtr = desc->boBufPayloadPtr;
+        pTaskConfigs[i].boBufPayloadSize = desc->boBufPayloadSize;
+        pTaskConfigs[i].procId = desc->procId;
+        pTaskConfigs[i].poolSize = desc->poolSize;
+        pTaskConfigs[i].batch = desc->batch ? desc->batch : 1;
+        pTaskConfigs[i].slots = desc->slots;
+        pTaskConfigs[i].check = desc->check;
+        pTaskConfigs[i].copy = desc->copy;
+        /* the host's direction seen from this side */
+        pTaskConfigs[i].thrDirection = desc->thrDirection == unidirectional_recv ?
+                                       unidirectional_send :
+                                       desc->thrDirection == unidirectional_send ?
+                                       unidirectional_recv : bidirectional;
+#if CHATTER
+        MqOs_printf("Stream %d: Direction:%d messages: %d Wait Time(in us):%d payload: %d bytes, boBufPayloadPtr:%x, boBufPayloadSize:%d\n",
+                    i,
+                    pTaskConfigs[i].thrDirection,
+                    pTaskConfigs[i].numMessages,
+                    pTaskConfigs[i].numWaitTime,
+                    pTaskConfigs[i].payloadSize,
+                    pTaskConfigs[i].boBufPayloadPtr,
+                    pTaskConfigs[i].boBufPayloadSize);
+#endif
+    }
+
+    /* the table has been read, let the host go on */
+    status = MessageQ_put(remoteQueueId, msg);
+    if (status != MessageQ_S_SUCCESS) {
+        MqOs_abort("MessageQ_put had a failure/error\n");
+    }
+
+    MessageQ_delete(&messageQ);
+
+    /* Create N tasks to correspond with host side N thread test app: */
+    for (i = 0; i < numThreads; i++) {
+        pTaskConfigs[i].thrId = MqOs_taskCreate(
+            pTaskConfigs[i].thrDirection == unidirectional_recv ? loopbackFxn_Recv :
+            pTaskConfigs[i].thrDirection == unidirectional_send ? loopbackFxn_Send :
+            loopbackFxn_Echo, &pTaskConfigs[i]);
+        if (pTaskConfigs[i].thrId == NULL) {
+            MqOs_abort("Could not create a stream task\n");
+        }
+    }
+    for (i = 0; i < numThreads; i++) {
+        MqOs_taskJoin(pTaskConfigs[i].thrId);
+    }
+
+    dataTransactFxn();
+
+    MqOs_free(pTaskConfigs, numThreads * sizeof(SyncMsg));
+    MqOs_sessionEnd();
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== mq_remote.h ========
+ *
+ *  Remote side of the MessageQ zero copy test: takes the host's handshake,
+ *  runs a send, receive or echo task per host stream and answers the
+ *  final data transaction. Portable over mq_remote_os.h.
+ */
+
+#ifndef ti_ipc_tests_mq_remote__include
+#define ti_ipc_tests_mq_remote__include
+
+#include <stdint.h>
+
+#include "mq_remote_os.h"
+
+#include <ti/ipc/MessageQ.h>
+#include <ti/ipc/MultiProc.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define SLAVE_MESSAGEQNAME "SLAVE"
+#define HOST_MESSAGEQNAME  "HOST"
+#define A15_MESSAGEQNAME   "A15"
+#define M4_MESSAGEQNAME    "M4"
+
+enum ThreadDirection {
+        unidirectional_send = 0,
+        unidirectional_recv,
+        bidirectional
+};
+
+/*
+ * Copy paths of the host's copy= key. Both sides copy every payload: in
+ * and out of the message body with COPY_INLINE, between a private buffer
+ * and the stream's region of the shared buffer with COPY_BO.
+ */
+enum CopyMode {
+        COPY_NONE = 0,
+        COPY_INLINE,
+        COPY_BO
+};
+
+/*
+ * Stream table the host writes at the start of the shared buffer. The
+ * handshake message only carries its address, size and stream count.
+ */
+#define STREAM_TABLE_MAGIC      0x5354424C
+
+typedef struct StreamDesc {
+    unsigned int boBufPayloadPtr; /* Stream's buffer region */
+    unsigned int boBufPayloadSize;
+    unsigned int numMessages;
+    unsigned int numWaitTime;
+    unsigned int payloadSize;
+    unsigned int procId; /* Core the stream talks to */
+    unsigned int thrDirection; /* As seen from the host */
+    unsigned int poolSize;
+    unsigned int batch;
+    unsigned int slots;
+    unsigned int check;
+    unsigned int copy; /* CopyMode */
+} StreamDesc;
+
+typedef struct StreamTable {
+    unsigned int magic;
+    unsigned int numStreams;
+    unsigned int descSize;
+    unsigned int reserved;
+    StreamDesc stream[];
+} StreamTable;
+
+typedef struct RemoteBufSyncMsg {
+    MessageQ_MsgHeader header;
+    unsigned int boBufPayloadPtr; /* Device address of the payload */
+    unsigned int boBufPayloadSize;
+    unsigned int sendTs; /* Sync counter when the sender put the message */
+    unsigned int recvTs; /* Sync counter when the receiver got it, 0 until then */
+    unsigned int crc; /* CRC32C of the payload, check=1 only */
+} RemoteBufSyncMsg;
+
+/*!
+ *  @brief      Compute structure
+ */
+typedef struct {
+    int         size;
+    uint32_t *  inBuf;
+} MxServer_Compute;
+
+/*!
+ *  @brief      Sample function which has pointer parameter to
+ *              a structure with two embedded pointers.
+ */
+int32_t MxServer_compute(MxServer_Compute *compute);
+
+/*
+ *  MmRpc benchmark (-m on the host). MxServer_bench<P> takes the bench
+ *  structure and P - 1 scalars, its buffers are the embedded pointers.
+ */
+#define MX_BENCH_MAX_PARAMS     8
+#define MX_BENCH_MAX_XLTS       8
+
+typedef struct {
+    uint32_t    size;       /* bytes read from every buffer */
+    uint32_t    numBufs;
+    uint32_t *  buf[MX_BENCH_MAX_XLTS];
+} MxServer_Bench;
+
+/* Sum of the scalars and of every word read, for the host to check */
+int32_t MxServer_bench(MxServer_Bench *bench, uint32_t scalars);
+
+/* Once, before the first session */
+Void MqRemote_init(Void);
+
+/*
+ *  Waits for a host run on SLAVE_<core name> and serves it to the end.
+ *  Returns a negative value when no handshake came.
+ */
+Int MqRemote_session(Void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== mq_remote_os.h ========
+ *
+ *  What the remote side of the MessageQ zero copy test needs from the OS
+ *  it runs on. mq_remote.c only calls these and the IPC MessageQ API, so
+ *  it builds for the IPU with SYS/BIOS (messageq_zerocpy.c) and as a Linux
+ *  process against the loopback shim (messageq_loopback/mqloop_remote.c,
+ *  built with MQ_LOOPBACK).
+ *
+ *  Buffers are handed around as 32-bit device addresses, MqOs_ptr() and
+ *  MqOs_devaddr() convert them to and from local pointers.
+ */
+
+#ifndef ti_ipc_tests_mq_remote_os__include
+#define ti_ipc_tests_mq_remote_os__include
+
+#ifdef MQ_LOOPBACK
+#include <stdio.h>
+#include <ti/ipc/Std.h>
+
+#define MqOs_printf     printf
+#define MqOs_sprintf    sprintf
+#else
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+#define MqOs_printf     System_printf
+#define MqOs_sprintf    System_sprintf
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef Void (*MqOs_TaskFxn)(Void *arg);
+typedef struct MqOs_Task *MqOs_TaskHandle;
+
+/* Starts fxn(arg) in a task of its own, NULL on failure */
+MqOs_TaskHandle MqOs_taskCreate(MqOs_TaskFxn fxn, Void *arg);
+
+/* Waits for the task to return and releases it */
+Void MqOs_taskJoin(MqOs_TaskHandle task);
+
+Void MqOs_sleepUs(UInt32 usecs);
+
+/* Free running microseconds, for elapsed times */
+UInt32 MqOs_timeUs(Void);
+
+/* 32K sync counter shared with the host, for one-way latencies */
+UInt32 MqOs_syncClock(Void);
+
+/* Rate of MqOs_syncClock() in Hz */
+UInt32 MqOs_syncClockHz(Void);
+
+/* Zeroed memory, NULL on failure */
+Void *MqOs_alloc(SizeT size);
+Void MqOs_free(Void *ptr, SizeT size);
+
+Void *MqOs_ptr(UInt32 devaddr);
+UInt32 MqOs_devaddr(Void *ptr);
+
+/* Make the host's writes visible to us and ours to the host */
+Void MqOs_cacheInv(Void *ptr, SizeT size);
+Void MqOs_cacheWb(Void *ptr, SizeT size);
+
+/* Does not return */
+Void MqOs_abort(const Char *msg);
+
+/* Around the streams of one host run, for load measurements */
+Void MqOs_sessionStart(Void);
+Void MqOs_sessionEnd(Void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -38,13 +38,41 @@
  */
 
 /* Standard headers */
+#define _GNU_SOURCE
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <errno.h>
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include <sys/param.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/types.h>
+#ifdef __has_include
+#if __has_include(<linux/dma-buf.h>)
+#include <linux/dma-buf.h>
+#endif
+#endif
+
+/* DMA-BUF CPU access, <linux/dma-buf.h> of kernels before 4.6 lacks it */
+#ifndef DMA_BUF_IOCTL_SYNC
+struct dma_buf_sync {
+    __u64 flags;
+};
+#define DMA_BUF_SYNC_READ       (1 << 0)
+#define DMA_BUF_SYNC_WRITE      (2 << 0)
+#define DMA_BUF_SYNC_RW         (DMA_BUF_SYNC_READ | DMA_BUF_SYNC_WRITE)
+#define DMA_BUF_SYNC_START      (0 << 2)
+#define DMA_BUF_SYNC_END        (1 << 2)
+#define DMA_BUF_IOCTL_SYNC      _IOW('b', 0, struct dma_buf_sync)
+#endif
 
 /* IPC Headers */
 #include <ti/ipc/Std.h>
@@ -57,6 +85,10 @@
 #include <omap/omap_drm.h>
 #include <libdrm/omap_drmif.h>
 
+#include "hist.h"
+#include "crc32c.h"
+#include "memcopy.h"
+
 /* App defines: Must match on remote proc side: */
 #define HEAPID                      0u
 #define A15_HANDSHAKE_MQNAME     "A15_RECEIVER_HANDSHAKE"
@@ -77,9 +109,8 @@
 /*OMAP5 remoteproc1:IPU:proc id 1*/
 #define COREPROC1					1u
 
-/*Before increasing the below value handle the thrDirection variable capacity in SyncMsg 
- and check the same on the BIOS side code too*/
-#define  MAX_NUM_THREADS  100
+/* Streams of the cfg file are read into an array grown by this many */
+#define  CONFIG_CHUNK  64
 
 #define MAX_INPUT_STR_SIZE                      (128)
 /** ============================================================================
@@ -95,32 +126,164 @@ typedef struct {
     uint32_t *  inBuf; /* This is the shared region space address */
 } Mx_Compute;
 
+/*
+ * Mx_Bench and its limits must match MxServer_Bench in mq_remote.h. The
+ * -m mode (run_rpc_bench()) passes it as the first parameter of each
+ * call, see rpc_bench_ctx().
+ */
+#define MX_BENCH_MAX_PARAMS     8
+#define MX_BENCH_MAX_XLTS       8
+
+/* Defaults of the -m keys calls and size */
+#define RPC_BENCH_CALLS         1000
+#define RPC_BENCH_SIZE          4096
+
+typedef struct {
+    uint32_t    size;       /* bytes the remote reads from every buffer */
+    uint32_t    numBufs;
+    uint32_t *  buf[MX_BENCH_MAX_XLTS];
+} Mx_Bench;
+
 
 typedef struct RemoteBufSyncMsg {
     MessageQ_MsgHeader header;
     unsigned int boBufPayloadPtr; /*Shared Region pointer address to be exchanged using MessageQ*/
     unsigned int boBufPayloadSize; /*Shared Region pointer address  Size*/
+    unsigned int sendTs; /* Sync counter when the sender put the message */
+    unsigned int recvTs; /* Sync counter when the receiver got it, 0 until then */
+    unsigned int crc; /* CRC32C of the payload, check=1 only */
 } RemoteBufSyncMsg;
 
 
+/*
+ *  Handshake
+ *
+ *  The host writes one StreamDesc per stream into a StreamTable at the
+ *  start of the shared buffer, ahead of the stream payloads, and sends
+ *  the remote a single SyncMsg with the table's device address. The
+ *  remote reads the table, starts its side of every stream and returns
+ *  the SyncMsg, so setup is one round trip whatever the stream count.
+ *  The layout must match the remote side.
+ */
+#define STREAM_TABLE_MAGIC      0x5354424C  /* "STBL" */
+#define STREAM_TABLE_ALIGN      128
+
 typedef struct SyncMsg {
     MessageQ_MsgHeader header; /* This is a mandatory requirement for MessageQ_alloc */
-    unsigned int boBufPayloadPtr; /*Shared Region pointer address to be exchanged using MessageQ*/
-    unsigned int boBufPayloadSize; /*Shared Region pointer address  Size*/
-    unsigned int numThreads; /* Indicates the number of threads to the other core: Handshake */
-    unsigned int numMessages; /* Indicates the number of messages: Handshake */
-    unsigned int numWaitTime; /* Indicates the sleep/wait between send messages: Handshake */
-    unsigned int payloadSize; /* Indicates the size of the payload which will be carried by each message: Handshake */
-    unsigned int procId; /* Indicates the size of the payload which will be carried by each message: Handshake */
-    unsigned int thrDirection; /* Used a double to use each bit field for a thread. hence restriction of 64 threads*/
+    unsigned int tablePtr; /* Device address of the StreamTable */
+    unsigned int tableSize; /* Bytes of the StreamTable */
+    unsigned int numThreads; /* Streams in the table */
 } SyncMsg;
 
+typedef struct StreamDesc {
+    unsigned int boBufPayloadPtr; /* Device address of the stream's buffer region */
+    unsigned int boBufPayloadSize; /* Bytes of one payload */
+    unsigned int numMessages;
+    unsigned int numWaitTime; /* Interval between messages, us */
+    unsigned int payloadSize;
+    unsigned int procId; /* Core the stream talks to */
+    unsigned int thrDirection; /* ThreadDirection, as seen from the host */
+    unsigned int poolSize; /* Messages preallocated by the sender of this stream, 0 = alloc per message */
+    unsigned int batch; /* Messages the sender puts per wakeup */
+    unsigned int slots; /* Buffer slots of the stream, 0 = one shared slice */
+    unsigned int check; /* Payloads carry a seeded pattern and its CRC32C */
+    unsigned int copy; /* CopyMode of the stream */
+} StreamDesc;
+
+typedef struct StreamTable {
+    unsigned int magic; /* STREAM_TABLE_MAGIC */
+    unsigned int numStreams;
+    unsigned int descSize; /* sizeof(StreamDesc) */
+    unsigned int reserved;
+    StreamDesc stream[];
+} StreamTable;
+
 enum ThreadDirection {
 	unidirectional_send = 0,
 	unidirectional_recv,
 	bidirectional
 };
 
+/*
+ *  Receive strategies (recv= in the cfg)
+ *
+ *  RECV_BLOCK sleeps in MessageQ_get until a message arrives. RECV_POLL
+ *  never sleeps: it calls MessageQ_get with a zero timeout and yields the
+ *  CPU after every spinUs without a message. RECV_SPIN polls for up to
+ *  spinUs and then blocks, so a message that arrives within the budget
+ *  skips the wakeup at the cost of up to spinUs of CPU.
+ */
+enum RecvMode {
+	RECV_BLOCK = 0,
+	RECV_POLL,
+	RECV_SPIN
+};
+
+#define DEFAULT_SPIN_US     50
+
+/*
+ *  Copy paths (copy= in the cfg)
+ *
+ *  The zero copy path passes the address of the payload in the shared
+ *  buffer and nobody touches the payload. The copy paths are the baseline
+ *  it saves against, with both sides copying every payload:
+ *    COPY_INLINE  the payload travels in the message body, the sender
+ *                 copies it in and the receiver out
+ *    COPY_BO      the sender copies it from a private buffer into the
+ *                 stream's region of the shared buffer, the receiver from
+ *                 there into its private buffer
+ *  The host copies with the memcpy= kernel of memcopy.h. On the target a
+ *  MessageQ message rides in a 512 byte rpmsg buffer, so COPY_INLINE
+ *  payloads are limited to COPY_INLINE_MAX bytes.
+ */
+enum CopyMode {
+	COPY_NONE = 0,
+	COPY_INLINE,
+	COPY_BO
+};
+
+/*
+ *  Shared buffer mapping (-b on the command line)
+ *
+ *  BUF_WC maps inBuf_bo write-combined: stores stream out, every load goes
+ *  to DDR. BUF_CACHED maps it cached and brackets each CPU access with the
+ *  DMA-BUF sync ioctl, which cleans or invalidates the whole buffer. All
+ *  streams share that one buffer, so a receiver's invalidate would throw
+ *  away lines a sender has written but not cleaned yet; the brackets are
+ *  serialized by bufSyncLock, held from buf_begin() to buf_end().
+ */
+enum BufMode {
+	BUF_WC = 0,
+	BUF_CACHED
+};
+
+#define RPMSG_MSG_MAX       496
+#define COPY_INLINE_MAX     (RPMSG_MSG_MAX - sizeof(RemoteBufSyncMsg))
+#define MSG_INLINE(msg)     ((void *)((char *)(msg) + sizeof(RemoteBufSyncMsg)))
+
+/*
+ *  Send pacing (pace= in the cfg)
+ *
+ *  PACE_SLEEP is the original behaviour: a usleep of interval after every
+ *  put, so the real period is interval plus the send cost plus the
+ *  scheduler delay. The other modes are open loop. Every message has an
+ *  intended send time on an absolute schedule and the sender sleeps until
+ *  it; a sender that falls behind catches up instead of stretching the
+ *  schedule.
+ *    PACE_CONSTANT  one message every interval us (default)
+ *    PACE_POISSON   exponential gaps with a mean of interval us
+ *    PACE_BURST     burst messages back to back every burst * interval us
+ *  Paced messages are stamped with their intended send time, so one-way
+ *  latencies include the time a message waited behind a late sender
+ *  instead of hiding it (coordinated omission).
+ */
+enum PaceMode {
+	PACE_SLEEP = 0,
+	PACE_CONSTANT,
+	PACE_POISSON,
+	PACE_BURST
+};
+
 typedef struct thread_info {    /* Used as argument to thread_start() */
     pthread_t thread_id;        /* ID returned by pthread_create() */
     unsigned int thread_num;       /* Application-defined thread # */
@@ -131,28 +294,80 @@ typedef struct thread_info {    /* Used as argument to thread_start() */
     unsigned int procId; /* Indicates the procid for this thread: Handshake */
     unsigned int boBufPayloadPtr; /*Shared Region pointer address per thread*/
     unsigned int boBufPayloadSize; /*Shared Region Size for this index of address*/
+    unsigned int bufOffset; /* Offset of the stream's region in the shared buffer */
+    unsigned int poolSize; /* Preallocated messages, 0 = MessageQ_alloc/free per message */
+    unsigned int poolExhausted; /* Sends that found the pool empty */
+    unsigned int poolLowWater; /* Fewest free messages seen before a send */
+    long poolWaitUs; /* Time spent waiting for messages to come back */
+    long long acquireNs; /* Total time spent getting a message to send */
+    Hist *latency; /* One-way latency of this stream, ns */
+    int cpu; /* CPU the thread is pinned to, -1 = any */
+    int recvMode; /* RECV_* */
+    unsigned int spinUs; /* Poll budget of RECV_POLL/RECV_SPIN */
+    unsigned int spinHits; /* Messages found while polling */
+    unsigned int blocks; /* MessageQ_get calls that could sleep */
+    long long cpuNs; /* CPU time of the thread */
+    long long activeNs; /* Wall time of the thread's message loop */
+    int pace; /* PACE_* */
+    unsigned int burst; /* Messages per burst for PACE_BURST */
+    Hist *sendLag; /* Actual minus intended send time, ns */
+    int policy; /* SCHED_OTHER, SCHED_FIFO or SCHED_RR */
+    int prio; /* Static priority for SCHED_FIFO/SCHED_RR */
+    int schedFailed; /* Created without policy/prio, not permitted */
+    int runPolicy; /* Placement seen from inside the thread */
+    int runPrio;
+    int cpuFirst;
+    int cpuLast;
+    unsigned int migrations;
+    char allowed[64]; /* CPUs the thread may run on */
+    unsigned int batch; /* Messages put per wakeup / drained per wakeup */
+    unsigned int wakeups; /* Receiver: wakeups that returned messages */
+    unsigned int maxDrain; /* Receiver: most messages handled in one wakeup */
+    unsigned int slots; /* Buffer ring depth, 0 = one slice for all messages */
+    uint32_t *bufCpuPtr; /* CPU address of the stream's buffer region */
+    unsigned int slotErrors; /* Receiver: slots whose tags did not match */
+    unsigned int check; /* Fill and verify every payload, see payload_fill() */
+    unsigned int crcErrors; /* Receiver: payloads whose CRC32C did not match */
+    long long checkNs; /* Time spent filling or verifying payloads */
+    unsigned int outstanding; /* Round trip: messages in flight */
+    Hist *rtt; /* Round trip: put to return, ns */
+    int reactor; /* Event loop driving the stream, -1 = its own thread */
+    unsigned int msgsDone; /* Messages put or received and checked */
+    unsigned int idErrors; /* Messages out of sequence */
+    unsigned int copy; /* CopyMode */
+    int copyKernel; /* CopyKernel of memcopy.h */
+    CopyFxn copyFxn;
+    void *copyBuf; /* Private end of the copy */
+    long long copyNs; /* Time spent copying payloads */
+    long long syncNs; /* Time spent in DMA-BUF sync around buffer accesses */
+    long long openNs; /* Time until the remote queue could be opened */
+    unsigned int opens; /* MessageQ_open calls it took */
+    long long firstNs; /* First message put or received, CLOCK_MONOTONIC */
 }thrConfigs;
 
 typedef struct stProPerfConfig {
 	int procId;
 	int numThreads;
-	int bufferPtr;
+	uint32_t *bufferPtr;
 	int bufferPtrRemoteAddr;
 	int bufferPtrSize;
 	int totalReqPayloadSize;
 	thrConfigs *pThrConfig;
 	Mx_Compute *compute;
-	SyncMsg stSyncMsg;
 }stProPerfConfig;
 
 
 static void * pingThreadFxn_uni_send(void *arg);
 static void * pingThreadFxn_uni_recv(void *arg);
+static void * pingThreadFxn_bidir(void *arg);
 
 struct omap_device *dev = NULL;
 struct omap_bo *compute_bo = NULL;
 struct omap_bo *inBuf_bo = NULL;
 int drmFd = 0;
+int bufMode = BUF_WC;
+int inBuf_fd = -1; /* dma-buf of a cached inBuf_bo, -1 = no sync needed */
+pthread_mutex_t bufSyncLock = PTHREAD_MUTEX_INITIALIZER;
 
 /* hande used for remote communication */
 static MmRpc_Handle Mx_rpcIpu = NULL;
@@ -278,6 +493,123 @@ int32_t Mx_compute_Release()
     return 0;
 }
 
+static long long nsecs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int buf_ioctl(uint64_t flags)
+{
+    struct dma_buf_sync sync;
+    int ret;
+
+    sync.flags = flags;
+    while ((ret = ioctl(inBuf_fd, DMA_BUF_IOCTL_SYNC, &sync)) < 0 &&
+           (errno == EINTR || errno == EAGAIN))
+        ;
+    return ret;
+}
+
+/*
+ * Begins CPU access to a cached inBuf_bo and holds bufSyncLock until the
+ * matching buf_end(). Both return the time they took, waiting included.
+ */
+static long long buf_begin(uint64_t flags)
+{
+    long long start;
+
+    if (inBuf_fd < 0) {
+        return 0;
+    }
+
+    start = nsecs();
+    pthread_mutex_lock(&bufSyncLock);
+    buf_ioctl(DMA_BUF_SYNC_START | flags);
+    return nsecs() - start;
+}
+
+static long long buf_end(uint64_t flags)
+{
+    long long start;
+
+    if (inBuf_fd < 0) {
+        return 0;
+    }
+
+    start = nsecs();
+    buf_ioctl(DMA_BUF_SYNC_END | flags);
+    pthread_mutex_unlock(&bufSyncLock);
+    return nsecs() - start;
+}
+
+/*
+ *  Sync clock
+ *
+ *  The 32K sync counter can be read by the A15 and by the IPUs (through
+ *  its L3 alias 0x6AE04030), so a message stamped on one core can be timed
+ *  on the other. Resolution is one tick, 30.5 us. Where the counter cannot
+ *  be mapped, the stamps are CLOCK_MONOTONIC in ns instead, which only
+ *  gives valid one-way latencies when both ends run on this host, and
+ *  wraps after 4.29 s.
+ */
+#define SYNC_COUNTER_32K_BASE       0x4AE04000
+#define SYNC_COUNTER_32K_OFFSET     0x30
+#define SYNC_COUNTER_HZ             32768
+
+static volatile uint32_t *syncCounter = NULL;
+
+static void syncClock_init(void)
+{
+#if defined(__arm__) && !defined(MQ_LOOPBACK)
+    void *base = MAP_FAILED;
+    int fd;
+
+    fd = open("/dev/mem", O_RDONLY | O_SYNC);
+    if (fd >= 0) {
+        base = mmap(NULL, 4096, PROT_READ, MAP_SHARED, fd, SYNC_COUNTER_32K_BASE);
+        close(fd);
+    }
+    if (base != MAP_FAILED) {
+        syncCounter = (volatile uint32_t *)((char *)base + SYNC_COUNTER_32K_OFFSET);
+        return;
+    }
+#endif
+    printf("NOTE: 32K sync counter not mapped, one-way latencies use CLOCK_MONOTONIC\n");
+}
+
+static uint32_t syncClock_read(void)
+{
+    if (syncCounter) {
+        return *syncCounter;
+    }
+    return (uint32_t)nsecs();
+}
+
+static uint64_t syncClock_ns(uint32_t from, uint32_t to)
+{
+    uint32_t ticks = to - from;
+
+    /* ticks * 10^9 / 32768 */
+    return syncCounter ? (uint64_t)ticks * 1953125 / 64 : ticks;
+}
+
+static uint32_t syncClock_ticks(long long ns)
+{
+    return syncCounter ? (uint32_t)(ns * 64 / 1953125) : (uint32_t)ns;
+}
+
+static void record_oneway(Hist *h, MessageQ_Msg msg)
+{
+    RemoteBufSyncMsg *m = (RemoteBufSyncMsg *)msg;
+
+    if (h && m->recvTs) {
+        hist_add(h, syncClock_ns(m->sendTs, m->recvTs));
+    }
+}
+
 long diff(struct timespec dstart, struct timespec dend)
 {
     struct timespec temp;
@@ -336,9 +668,12 @@ static int callCompute_Linux(stProPerfConfig *stExpConfig)
 
     /* allocate an input buffer in shared memory */
     size = stExpConfig->compute->size * sizeof(uint32_t);
-    inBuf_bo = omap_bo_new(dev, size, OMAP_BO_WC);
+    inBuf_bo = omap_bo_new(dev, size, bufMode == BUF_CACHED ? OMAP_BO_CACHED : OMAP_BO_WC);
     if (inBuf_bo) {
         inBufPtr = (uint32_t *)omap_bo_map(inBuf_bo);
+        if (bufMode == BUF_CACHED) {
+            inBuf_fd = omap_bo_dmabuf(inBuf_bo);
+        }
     }
     else {
         fprintf(stderr, "failed to allocate inBuf_bo\n");
@@ -350,10 +685,22 @@ static int callCompute_Linux(stProPerfConfig *stExpConfig)
         return -1;
     }
 
+    /* a cached buffer is only usable if the exporter does the cache maintenance */
+    if (inBuf_fd >= 0) {
+        pthread_mutex_lock(&bufSyncLock);
+        if (buf_ioctl(DMA_BUF_SYNC_START | DMA_BUF_SYNC_WRITE) < 0) {
+            fprintf(stderr, "inBuf_bo has no DMA-BUF sync (%s), cached buffer "
+                    "runs without cache maintenance\n", strerror(errno));
+            inBuf_fd = -1;
+            pthread_mutex_unlock(&bufSyncLock);
+        }
+    }
+
     /* fill input buffer with seed value */
     for (i = 0; i < stExpConfig->compute->size; i++) {
         inBufPtr[i] = 0xbeefdead;
     }
+    buf_end(DMA_BUF_SYNC_WRITE);
 
     stExpConfig->compute->inBuf = (uint32_t *)inBufPtr;
 
@@ -379,6 +726,7 @@ static int callCompute_Linux(stProPerfConfig *stExpConfig)
 #endif
     /*This checks Data Transaction at mmrpc level;check the output buffer */
    /* starting at index 1 because 0th index contains translated address of inBufPtr*/
+    buf_begin(DMA_BUF_SYNC_READ);
     for (i = 1; i < stExpConfig->compute->size; i++) {
         if (inBufPtr[i] != 0xdeadbeef) {
             status = 1;
@@ -386,14 +734,138 @@ static int callCompute_Linux(stProPerfConfig *stExpConfig)
             break;
         }
     }
+    buf_end(DMA_BUF_SYNC_READ);
 
-    stExpConfig->bufferPtr = (unsigned int)stExpConfig->compute->inBuf;
+    stExpConfig->bufferPtr = stExpConfig->compute->inBuf;
     stExpConfig->bufferPtrRemoteAddr = (unsigned int)stExpConfig->compute->inBuf[0];
     stExpConfig->bufferPtrSize = stExpConfig->compute->size * sizeof(uint32_t);
 
     return (status);
 }
 
+/*
+ *  Buffer ring (slots= in the cfg)
+ *
+ *  With slots=K a stream owns K payload-sized slots of the shared buffer
+ *  instead of one slice that every message points at. The sender runs a
+ *  pool of K messages with message k bound to slot k, so holding a
+ *  message is holding its slot: the sender writes a slot only once its
+ *  message has come back, and the receiver puts the message back only
+ *  when it is done with the slot. The messages in the sender's pool are
+ *  its credits. The sender tags the first and last word of the slot with
+ *  the message id and the receiver checks them.
+ *
+ *  check=1 fills the rest of the slot with a pattern seeded by the stream
+ *  and message id and sends its CRC32C in the message; the receiver
+ *  recomputes it over the whole slot. Checking needs the slot to stay
+ *  untouched until the receiver is done with it, so it always runs on a
+ *  ring, of DEFAULT_CHECK_SLOTS when no slots= was given.
+ */
+#define DEFAULT_CHECK_SLOTS 4
+
+static unsigned int stream_bytes(const thrConfigs *thr)
+{
+    return thr->payloadSize * (thr->slots ? thr->slots : 1);
+}
+
+/* Messages of the stream carry the payload too with COPY_INLINE */
+static unsigned int msg_size(const thrConfigs *thr)
+{
+    return sizeof(RemoteBufSyncMsg) + (thr->copy == COPY_INLINE ? thr->payloadSize : 0);
+}
+
+/* Space of the stream table at the start of the shared buffer */
+static unsigned int stream_table_bytes(unsigned int numStreams)
+{
+    unsigned int size = sizeof(StreamTable) + numStreams * sizeof(StreamDesc);
+
+    return (size + STREAM_TABLE_ALIGN - 1) & ~(STREAM_TABLE_ALIGN - 1);
+}
+
+static uint32_t *slot_ptr(const thrConfigs *thr, unsigned int devAddr)
+{
+    return thr->bufCpuPtr + (devAddr - thr->boBufPayloadPtr) / sizeof(uint32_t);
+}
+
+static void slot_tag(uint32_t *slot, unsigned int size, uint32_t tag)
+{
+    slot[0] = tag;
+    slot[size / sizeof(uint32_t) - 1] = tag;
+}
+
+static int slot_check(const uint32_t *slot, unsigned int size, uint32_t tag)
+{
+    return slot[0] == tag && slot[size / sizeof(uint32_t) - 1] == tag;
+}
+
+static const char *buf_mode_name(void)
+{
+    return bufMode == BUF_WC ? "wc" : inBuf_fd >= 0 ? "cached" : "cached-nosync";
+}
+
+/* The host reads or writes the payloads of the stream in the shared buffer */
+static int buf_access(const thrConfigs *thr)
+{
+    return thr->check || thr->slots || thr->copy == COPY_BO;
+}
+
+/*
+ *  Readiness of a remote queue
+ *
+ *  MessageQ has no event for a queue coming up, so MessageQ_open is retried
+ *  with a delay that starts at OPEN_BACKOFF_MIN_US and doubles up to
+ *  OPEN_BACKOFF_MAX_US: a remote that is up is found at once, one that is
+ *  still booting costs a hundred opens a second instead of a spinning core.
+ */
+#define OPEN_BACKOFF_MIN_US     50
+#define OPEN_BACKOFF_MAX_US     10000
+#define OPEN_TIMEOUT_S          60
+
+/* IPC bring-up milestones, CLOCK_MONOTONIC */
+typedef struct Bringup {
+    long long start;        /* main() */
+    long long ipc;          /* Ipc_start() returned */
+    long long rpc;          /* MmRpc connection and shared buffer set up */
+    long long ready;        /* remote handshake queue opened */
+    unsigned int opens;     /* MessageQ_open calls until then */
+    long long handshake;    /* remote read the stream table */
+    long long launch;       /* streams started */
+} Bringup;
+
+static Bringup bringup;
+
+static Int remote_open(String name, MessageQ_QueueId *queueId, long long *waitNs,
+                       unsigned int *opens)
+{
+    long long start = nsecs();
+    unsigned int delay = OPEN_BACKOFF_MIN_US, n = 1;
+    Int status;
+
+    while ((status = MessageQ_open(name, queueId)) == MessageQ_E_NOTFOUND) {
+        if (nsecs() - start > OPEN_TIMEOUT_S * 1000000000LL) {
+            printf("Remote queue %s not there after %d s\n", name, OPEN_TIMEOUT_S);
+            break;
+        }
+        usleep(delay);
+        delay = MIN(delay * 2, OPEN_BACKOFF_MAX_US);
+        n++;
+    }
+    if (waitNs) {
+        *waitNs = nsecs() - start;
+    }
+    if (opens) {
+        *opens = n;
+    }
+    return status;
+}
+
+static void first_msg(thrConfigs *thr)
+{
+    if (thr->msgsDone == 0) {
+        thr->firstNs = nsecs();
+    }
+}
+
 Int MessageQApp_handshake(stProPerfConfig stExpConfig)
 {
     Int32                    i = 0, status = 0;
@@ -402,7 +874,10 @@ Int MessageQApp_handshake(stProPerfConfig stExpConfig)
     MessageQ_QueueId         queueId = MessageQ_INVALIDMESSAGEQ;
     MessageQ_Handle          msgqHandle;
     char                     remoteQueueName[64];
-    int tempOffsetCtr = 0;
+    StreamTable              *table;
+    StreamDesc               *desc;
+    thrConfigs               *thr;
+    long long                start;
 
 #if PRINT_DEBUG
     printf("Entered MessageQApp_handshake\n");
@@ -422,11 +897,14 @@ Int MessageQApp_handshake(stProPerfConfig stExpConfig)
 #endif
     sprintf(remoteQueueName, "%s_%s", SLAVE_MESSAGEQNAME,
              MultiProc_getName(stExpConfig.procId));
-    /* Poll until remote side has it's messageQ created before we send: */
-    do {
-        status = MessageQ_open(remoteQueueName, &queueId);
-        sleep (1);
-    } while (status == MessageQ_E_NOTFOUND);
+    /* Wait until remote side has it's messageQ created before we send: */
+    if (bringup.ready) {
+        status = remote_open(remoteQueueName, &queueId, NULL, NULL);
+    }
+    else {
+        status = remote_open(remoteQueueName, &queueId, NULL, &bringup.opens);
+        bringup.ready = nsecs();
+    }
 
     if (status < 0) {
         printf("Error in MessageQ_open [%d]\n", status);
@@ -443,11 +921,37 @@ Int MessageQApp_handshake(stProPerfConfig stExpConfig)
         printf("Error in MessageQ_alloc\n");
         goto close_cleanup;
     }
-    
-    /* handshake with remote to set the number of loops */
-    MessageQ_setReplyQueue(msgqHandle, msg);
 
-    /* Ensuring first I handshake no. of threads/tasks so that a loop can be created at bios side*/
+    start = nsecs();
+    buf_begin(DMA_BUF_SYNC_WRITE);
+    table = (StreamTable *)stExpConfig.bufferPtr;
+    table->magic = STREAM_TABLE_MAGIC;
+    table->numStreams = stExpConfig.numThreads;
+    table->descSize = sizeof(StreamDesc);
+    table->reserved = 0;
+    for (i = 0; i < stExpConfig.numThreads; i++) {
+        thr = &stExpConfig.pThrConfig[i];
+        desc = &table->stream[i];
+        desc->boBufPayloadPtr = thr->boBufPayloadPtr;
+        desc->boBufPayloadSize = thr->payloadSize;
+        desc->numMessages = thr->numMessages;
+        desc->numWaitTime = thr->numWaitTime;
+        desc->payloadSize = thr->payloadSize;
+        desc->procId = thr->procId;
+        desc->thrDirection = thr->config_param;
+        desc->poolSize = thr->poolSize;
+        desc->batch = thr->batch;
+        desc->slots = thr->slots;
+        desc->check = thr->check;
+        desc->copy = thr->copy;
+    }
+    /* the table has to be out of the write buffers before the remote reads it */
+    __sync_synchronize();
+    buf_end(DMA_BUF_SYNC_WRITE);
+
+    MessageQ_setReplyQueue(msgqHandle, msg);
+    ((SyncMsg *)msg)->tablePtr = stExpConfig.bufferPtrRemoteAddr;
+    ((SyncMsg *)msg)->tableSize = stream_table_bytes(stExpConfig.numThreads);
     ((SyncMsg *)msg)->numThreads = stExpConfig.numThreads;
     status = MessageQ_put(queueId, msg);
     if (status < 0) {
@@ -455,39 +959,18 @@ Int MessageQApp_handshake(stProPerfConfig stExpConfig)
         goto free_cleanup;
     }
 
+    /* back once the remote has read the table */
     status = MessageQ_get(msgqHandle, &msg, MessageQ_FOREVER);
     if (status < 0) {
-            printf ("Error in MessageQ_get [0x%x]\n", status);
-        }
-   else {
-#if PRINT_DEBUG
-    printf("Exchanged thread count handshake with remote processor %s...\n",
-           MultiProc_getName(stExpConfig.procId));
-#endif
-	}
-
-	for (i = 0; i < stExpConfig.numThreads; i++) 
-	{
-		((SyncMsg *)msg)->boBufPayloadPtr = stExpConfig.bufferPtrRemoteAddr + tempOffsetCtr;
-		((SyncMsg *)msg)->boBufPayloadSize = stExpConfig.pThrConfig[i].payloadSize;
-		((SyncMsg *)msg)->numMessages = stExpConfig.pThrConfig[i].numMessages;
-		((SyncMsg *)msg)->numWaitTime = stExpConfig.pThrConfig[i].numWaitTime;
-		((SyncMsg *)msg)->payloadSize = stExpConfig.pThrConfig[i].payloadSize;
-		((SyncMsg *)msg)->procId = stExpConfig.pThrConfig[i].procId; 
-		((SyncMsg *)msg)->thrDirection = stExpConfig.pThrConfig[i].config_param;
-      		tempOffsetCtr += stExpConfig.pThrConfig[i].payloadSize;
-		status = MessageQ_put(queueId, msg);
-		if (status < 0) {
-			printf("MessageQ_put handshake failed [%d]\n", status);
-			goto free_cleanup;
-		}
-
-		status = MessageQ_get(msgqHandle, &msg, MessageQ_FOREVER);
-	        if (status < 0) {
-			printf ("Error in MessageQ_get [0x%x]\n", status);
-			break;
-	        }
-  	}
+        printf ("Error in MessageQ_get [0x%x]\n", status);
+        goto close_cleanup;
+    }
+    if (!bringup.handshake) {
+        bringup.handshake = nsecs();
+    }
+    printf("Handshake: %d streams in a %d byte table, %.2f ms\n",
+           stExpConfig.numThreads, ((SyncMsg *)msg)->tableSize,
+           (nsecs() - start) / 1000000.0);
 
 #if PRINT_DEBUG
     printf("Exchanged handshake with remote processor %s...\n",
@@ -512,142 +995,541 @@ exit:
     return (status);
 }
 
-static Void * pingThreadFxn_uni_send(void *arg)
+/*
+ *  Message pool
+ *
+ *  In pooled mode a sender allocates its messages once, sets its return
+ *  queue as the reply queue of each, and the receiving side puts every
+ *  message back instead of freeing it. Sends then only cost the transport,
+ *  not the shared heap.
+ */
+typedef struct MsgPool {
+    MessageQ_Handle returnQ;
+    MessageQ_Msg *msgs;
+    unsigned int size;
+    unsigned int numFree;
+    unsigned int lowWater;
+    unsigned int exhausted;
+    long long waitNs;
+    Hist *latency; /* filled from the stamps of returned messages */
+} MsgPool;
+
+static int MsgPool_create(MsgPool *pool, unsigned int size, unsigned int msgSize,
+                          char *name)
 {
-    struct thread_info pingThreadFxnData = *(struct thread_info *)arg;   
-    Int                      threadNum = 0;
-    Int32                    status     = 0;
-    MessageQ_Msg             msg        = NULL;
-    UInt16                   i;
-    MessageQ_QueueId         queueId = MessageQ_INVALIDMESSAGEQ;
-
-    char             remoteQueueName[64];
+    MessageQ_Params msgParams;
+    unsigned int i;
 
-    threadNum = pingThreadFxnData.thread_num;
-    sprintf(remoteQueueName, "%s_RECV_MQ_%d", M4_MESSAGEQNAME, threadNum );
-    
-    //printf("pingThreadFxn This thread sending to num: %d, Name: %s\n", threadNum,remoteQueueName);
-
-    /* Poll until remote side has it's messageQ created before we send: */
-    do {
-        status = MessageQ_open (remoteQueueName, &queueId);
-        sleep (1);
-    } while (status == MessageQ_E_NOTFOUND);
-    if (status < 0) {
-        printf ("Error in MessageQ_open [0x%x]\n", status);
-	return ((void *)status);
+    memset(pool, 0, sizeof(*pool));
+    MessageQ_Params_init(&msgParams);
+    pool->returnQ = MessageQ_create(name, &msgParams);
+    if (pool->returnQ == NULL) {
+        printf("Error in MessageQ_create %s\n", name);
+        return -1;
     }
-#if PRINT_DEBUG
-    else {
-        printf ("thread: %d, Remote queue: %s, QId: 0x%x\n",
-                 threadNum, remoteQueueName, queueId);
+
+    pool->msgs = malloc(size * sizeof(MessageQ_Msg));
+    if (pool->msgs == NULL) {
+        MessageQ_delete(&pool->returnQ);
+        return -1;
     }
-    printf ("\nthread: %d: Exchanging messages with remote processor...\n",
-            threadNum);
-#endif
-    for (i = 0 ; i < pingThreadFxnData.numMessages ; i++) {
-        /* Allocate message. */
-        msg = MessageQ_alloc (HEAPID, sizeof(RemoteBufSyncMsg));
-        if (msg == NULL) {
-            printf ("Error in MessageQ_alloc\n");
+
+    for (i = 0; i < size; i++) {
+        pool->msgs[i] = MessageQ_alloc(HEAPID, msgSize);
+        if (pool->msgs[i] == NULL) {
+            printf("Error in MessageQ_alloc, pool of %d messages\n", size);
             break;
         }
+        MessageQ_setReplyQueue(pool->returnQ, pool->msgs[i]);
+    }
+    pool->size = pool->numFree = pool->lowWater = i;
 
-        MessageQ_setMsgId (msg, i);
+    return (i == size) ? 0 : -1;
+}
 
-        /* Have the remote proc reply to this message queue */
-      ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr = pingThreadFxnData.boBufPayloadPtr;
-      ((RemoteBufSyncMsg *)msg)->boBufPayloadSize = pingThreadFxnData.boBufPayloadSize;
+/* Collects whatever has come back without blocking */
+static void MsgPool_collect(MsgPool *pool)
+{
+    MessageQ_Msg msg;
 
-        status = MessageQ_put (queueId, msg);
-        if (status < 0) {
-            printf ("Error in MessageQ_put [0x%x]\n", status);
-            break;
-        }
-        usleep (pingThreadFxnData.numWaitTime); /*Sleep for 2.5ms*/
+    while (pool->numFree < pool->size &&
+           MessageQ_get(pool->returnQ, &msg, 0) == MessageQ_S_SUCCESS) {
+        record_oneway(pool->latency, msg);
+        pool->msgs[pool->numFree++] = msg;
+    }
+
+    if (pool->numFree < pool->lowWater) {
+        pool->lowWater = pool->numFree;
     }
-    
-    MessageQ_close (&queueId);
-    return ((void *)status);
 }
 
-static Void * pingThreadFxn_uni_recv(void *arg)
+/* MsgPool_get without the wait, NULL while every message is in flight */
+static MessageQ_Msg MsgPool_poll(MsgPool *pool)
 {
-    struct thread_info pingThreadFxnData = *(struct thread_info *)arg;   
-    Int                      threadNum = 0;
-    Int32                    status     = 0;
-    MessageQ_Msg             msg        = NULL;
-    MessageQ_Params          msgParams;
-    UInt16                   i;
-    MessageQ_Handle          handle;
+    MsgPool_collect(pool);
+    return pool->numFree ? pool->msgs[--pool->numFree] : NULL;
+}
 
-    char             hostQueueName[64];
+static MessageQ_Msg MsgPool_get(MsgPool *pool)
+{
+    MessageQ_Msg msg;
+    long long start;
 
-    threadNum = pingThreadFxnData.thread_num;
-    sprintf(hostQueueName,   "%s_RECV_MQ_%d", A15_MESSAGEQNAME,  threadNum );
+    MsgPool_collect(pool);
 
-    //printf("pingThreadFxn_uni_recv This thread num: %d from Name:%s  \n", threadNum,hostQueueName);
-    
-    /* Create the local Message Queue for receiving. */
-    MessageQ_Params_init (&msgParams);
-    handle = MessageQ_create (hostQueueName, &msgParams);
-    if (handle == NULL) {
-        printf ("Error in MessageQ_create\n");
-        goto exit;
-    }
-#if PRINT_DEBUG
-    else {
-        printf ("thread: %d, Local Message: %s, QId: 0x%x\n",
-            threadNum, hostQueueName, MessageQ_getQueueId(handle));
-    }
-#endif
-    for (i = 0 ; i < pingThreadFxnData.numMessages ; i++) {
-        status = MessageQ_get(handle, &msg, MessageQ_FOREVER);
-        if (status < 0) {
-            printf ("Error in MessageQ_get [0x%x]\n", status);
-            break;
+    if (pool->numFree == 0) {
+        pool->exhausted++;
+        start = nsecs();
+        if (MessageQ_get(pool->returnQ, &msg, MessageQ_FOREVER) < 0) {
+            return NULL;
         }
-        else {
-            /* Validate the returned message. */
-            if ((msg != NULL) && (MessageQ_getMsgId (msg) != i)) {
-                printf ("Data integrity failure!\n"
-                        "    Expected %d\n"
-                        "    Received %d\n",
-                        i, MessageQ_getMsgId (msg));
-                break;
-            }
-            status = MessageQ_free (msg);
-       }
-    }
-
-    /* Clean-up */
-    status = MessageQ_delete (&handle);
-    if (status < 0) {
-        printf ("Error in MessageQ_delete [0x%x]\n", status);
+        pool->waitNs += nsecs() - start;
+        record_oneway(pool->latency, msg);
+        return msg;
     }
 
-exit:
-    return ((void *)status);
+    return pool->msgs[--pool->numFree];
 }
 
-
-Int dataTransactFxn(stProPerfConfig stExpConfig)
+static void MsgPool_delete(MsgPool *pool)
 {
+    MessageQ_Msg msg;
+
+    if (pool->returnQ == NULL) {
+        return;
+    }
+
+    /* Wait for the messages still in flight */
+    while (pool->numFree < pool->size &&
+           MessageQ_get(pool->returnQ, &msg, MessageQ_FOREVER) == MessageQ_S_SUCCESS) {
+        record_oneway(pool->latency, msg);
+        pool->msgs[pool->numFree++] = msg;
+    }
+
+    while (pool->numFree > 0) {
+        MessageQ_free(pool->msgs[--pool->numFree]);
+    }
+
+    free(pool->msgs);
+    MessageQ_delete(&pool->returnQ);
+}
+
+static Int recv_get(MessageQ_Handle handle, MessageQ_Msg *msg, thrConfigs *thr)
+{
+    long long start, now;
+    Int status;
+
+    if (thr->recvMode == RECV_BLOCK) {
+        thr->blocks++;
+        return MessageQ_get(handle, msg, MessageQ_FOREVER);
+    }
+
+    start = nsecs();
+    for (;;) {
+        status = MessageQ_get(handle, msg, 0);
+        if (status != MessageQ_E_TIMEOUT) {
+            if (status == MessageQ_S_SUCCESS) {
+                thr->spinHits++;
+            }
+            return status;
+        }
+
+        now = nsecs();
+        if (now - start >= thr->spinUs * 1000LL) {
+            if (thr->recvMode == RECV_SPIN) {
+                thr->blocks++;
+                return MessageQ_get(handle, msg, MessageQ_FOREVER);
+            }
+            sched_yield();
+            start = now;
+        }
+    }
+}
+
+/*
+ *  Placement as seen from inside the thread: policy, priority, allowed
+ *  CPUs and the CPU it started on, then the CPU changes while it runs.
+ */
+static void placement_start(thrConfigs *thr)
+{
+    struct sched_param param;
+    cpu_set_t cpus;
+    int c, len = 0, first = -1;
+
+    pthread_getschedparam(pthread_self(), &thr->runPolicy, &param);
+    thr->runPrio = param.sched_priority;
+    thr->cpuFirst = thr->cpuLast = sched_getcpu();
+    thr->migrations = 0;
+
+    thr->allowed[0] = '\0';
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        return;
+    }
+    /* as ranges, 0-3,6 */
+    for (c = 0; c <= CPU_SETSIZE; c++) {
+        if (c < CPU_SETSIZE && CPU_ISSET(c, &cpus)) {
+            if (first < 0) {
+                first = c;
+            }
+            continue;
+        }
+        if (first >= 0 && len < sizeof(thr->allowed) - 12) {
+            len += sprintf(thr->allowed + len, len ? ",%d" : "%d", first);
+            if (c - 1 > first) {
+                len += sprintf(thr->allowed + len, "-%d", c - 1);
+            }
+        }
+        first = -1;
+    }
+}
+
+static inline void placement_update(thrConfigs *thr)
+{
+    int c = sched_getcpu();
+
+    if (c != thr->cpuLast) {
+        thr->migrations++;
+        thr->cpuLast = c;
+    }
+}
+
+static long long thread_cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+typedef struct Pacer {
+    int mode;
+    long long next; /* Intended time of the next message, nsecs() */
+    long long gapNs;
+    unsigned int burst;
+    unsigned int inBurst;
+    unsigned int seed;
+} Pacer;
+
+static void pacer_init(Pacer *p, thrConfigs *thr)
+{
+    p->mode = thr->pace;
+    p->gapNs = thr->numWaitTime * 1000LL * thr->batch;
+    p->burst = thr->burst ? thr->burst : 1;
+    p->inBurst = 0;
+    p->seed = thr->thread_num + 1;
+    p->next = nsecs();
+}
+
+/* Returns the intended time of the next message and moves the schedule on */
+static long long pacer_next(Pacer *p)
+{
+    long long intended = p->next;
+    double u;
+
+    switch (p->mode) {
+    case PACE_POISSON:
+        u = (rand_r(&p->seed) + 1.0) / (RAND_MAX + 2.0);
+        p->next += (long long)(-log(u) * p->gapNs);
+        break;
+    case PACE_BURST:
+        if (++p->inBurst == p->burst) {
+            p->inBurst = 0;
+            p->next += p->gapNs * p->burst;
+        }
+        break;
+    default:
+        p->next += p->gapNs;
+        break;
+    }
+
+    return intended;
+}
+
+/* Sleeps until the intended time of the next message and returns it */
+static long long pacer_wait(Pacer *p)
+{
+    struct timespec ts;
+
+    if (p->mode == PACE_SLEEP) {
+        return nsecs();
+    }
+
+    ts.tv_sec = p->next / 1000000000LL;
+    ts.tv_nsec = p->next % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+
+    return pacer_next(p);
+}
+
+static void slot_bind(MsgPool *pool, const thrConfigs *thr)
+{
+    unsigned int k;
+
+    for (k = 0; k < pool->size; k++) {
+        ((RemoteBufSyncMsg *)pool->msgs[k])->boBufPayloadPtr =
+            thr->boBufPayloadPtr + k * thr->payloadSize;
+        ((RemoteBufSyncMsg *)pool->msgs[k])->boBufPayloadSize = thr->payloadSize;
+    }
+}
+
+/* Fills message i of a send stream and puts it, intended is when it was due */
+static Int send_msg(thrConfigs *thr, MessageQ_QueueId queueId, MessageQ_Msg msg,
+                    UInt16 i, long long intended)
+{
+    long long start, late;
+    Int status;
+
+    MessageQ_setMsgId (msg, i);
+
+    if (buf_access(thr)) {
+        thr->syncNs += buf_begin(DMA_BUF_SYNC_WRITE);
+    }
+    if (thr->check) {
+        start = nsecs();
+        ((RemoteBufSyncMsg *)msg)->crc =
+            payload_fill(slot_ptr(thr, ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr),
+                         thr->payloadSize / sizeof(uint32_t),
+                         payload_seed(thr->thread_num, i), i);
+        thr->checkNs += nsecs() - start;
+    }
+    else if (thr->slots) {
+        /* the slot is ours again, fill it */
+        slot_tag(slot_ptr(thr, ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr),
+                 thr->payloadSize, i);
+    }
+    else {
+        ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr = thr->boBufPayloadPtr;
+        ((RemoteBufSyncMsg *)msg)->boBufPayloadSize = thr->boBufPayloadSize;
+    }
+    if (thr->copy) {
+        start = nsecs();
+        thr->copyFxn(thr->copy == COPY_INLINE ? MSG_INLINE(msg) : (void *)thr->bufCpuPtr,
+                     thr->copyBuf, thr->payloadSize);
+        thr->copyNs += nsecs() - start;
+    }
+    if (buf_access(thr)) {
+        thr->syncNs += buf_end(DMA_BUF_SYNC_WRITE);
+    }
+    ((RemoteBufSyncMsg *)msg)->recvTs = 0;
+    /* backdate the stamp to the intended send time */
+    late = nsecs() - intended;
+    ((RemoteBufSyncMsg *)msg)->sendTs = syncClock_read() - syncClock_ticks(late);
+
+    status = MessageQ_put (queueId, msg);
+    if (status >= 0) {
+        first_msg(thr);
+        thr->msgsDone++;
+    }
+    return status;
+}
+
+static Void * pingThreadFxn_uni_send(void *arg)
+{
+    struct thread_info pingThreadFxnData = *(struct thread_info *)arg;   
+    Int                      threadNum = 0;
     Int32                    status     = 0;
-    MessageQ_Msg             msg1        = NULL;
-    MessageQ_Params          msgParams;
-    Int32                    i;
-    MessageQ_Handle          handle;
+    MessageQ_Msg             msg        = NULL;
+    UInt16                   i;
     MessageQ_QueueId         queueId = MessageQ_INVALIDMESSAGEQ;
+    MsgPool                  pool;
+    long long                start, tick = 0, intended, loopStart;
+    Pacer                    pacer;
+    thrConfigs               *thr = (thrConfigs *)arg;
 
     char             remoteQueueName[64];
-    char             hostQueueName[64];
+    char             poolQueueName[64];
 
-    sprintf(remoteQueueName, "%s_%d", SLAVE_MESSAGEQNAME,0);
-    sprintf(hostQueueName,   "%s_%d", HOST_MESSAGEQNAME,0);
+    threadNum = pingThreadFxnData.thread_num;
+    sprintf(remoteQueueName, "%s_RECV_MQ_%d", M4_MESSAGEQNAME, threadNum );
 
-    printf("dataTransactFxn: This function is a test to showcase data transaction\n");
+    if (pingThreadFxnData.poolSize) {
+        sprintf(poolQueueName, "%s_POOL_%d", A15_MESSAGEQNAME, threadNum);
+        if (MsgPool_create(&pool, pingThreadFxnData.poolSize,
+                           msg_size(thr), poolQueueName) < 0) {
+            MsgPool_delete(&pool);
+            return ((void *)-1);
+        }
+        pool.latency = pingThreadFxnData.latency;
+        if (thr->slots) {
+            slot_bind(&pool, thr);
+        }
+    }
+    
+    //printf("pingThreadFxn This thread sending to num: %d, Name: %s\n", threadNum,remoteQueueName);
+
+    /* Wait until remote side has it's messageQ created before we send: */
+    status = remote_open(remoteQueueName, &queueId, &thr->openNs, &thr->opens);
+    if (status < 0) {
+        printf ("Error in MessageQ_open [0x%x]\n", status);
+	return ((void *)(intptr_t)status);
+    }
+#if PRINT_DEBUG
+    else {
+        printf ("thread: %d, Remote queue: %s, QId: 0x%x\n",
+                 threadNum, remoteQueueName, queueId);
+    }
+    printf ("\nthread: %d: Exchanging messages with remote processor...\n",
+            threadNum);
+#endif
+    placement_start(thr);
+    pacer_init(&pacer, thr);
+    loopStart = nsecs();
+    for (i = 0 ; i < pingThreadFxnData.numMessages ; i++) {
+        /*
+         * A batch goes out on one pacing tick. Each of its messages was
+         * due when it would have been sent on its own, so the latency
+         * includes the wait for the batch to fill.
+         */
+        if (i % thr->batch == 0) {
+            tick = pacer_wait(&pacer);
+            placement_update(thr);
+        }
+        intended = tick - (thr->batch - 1 - i % thr->batch) *
+                          pingThreadFxnData.numWaitTime * 1000LL;
+
+        /* Allocate message. */
+        start = nsecs();
+        if (pingThreadFxnData.poolSize) {
+            msg = MsgPool_get(&pool);
+        }
+        else {
+            msg = MessageQ_alloc (HEAPID, msg_size(thr));
+        }
+        ((struct thread_info *)arg)->acquireNs += nsecs() - start;
+        if (msg == NULL) {
+            printf ("Error in MessageQ_alloc\n");
+            break;
+        }
+
+        status = send_msg(thr, queueId, msg, i, intended);
+        if (status < 0) {
+            printf ("Error in MessageQ_put [0x%x]\n", status);
+            break;
+        }
+        if (pacer.mode == PACE_SLEEP) {
+            if ((i + 1) % thr->batch == 0) {
+                usleep (pingThreadFxnData.numWaitTime * thr->batch);
+            }
+        }
+        else {
+            hist_add(thr->sendLag, nsecs() - tick);
+        }
+    }
+    thr->activeNs = nsecs() - loopStart;
+
+    if (pingThreadFxnData.poolSize) {
+        ((struct thread_info *)arg)->poolExhausted = pool.exhausted;
+        ((struct thread_info *)arg)->poolLowWater = pool.lowWater;
+        ((struct thread_info *)arg)->poolWaitUs = pool.waitNs / 1000;
+        MsgPool_delete(&pool);
+    }
+    
+    MessageQ_close (&queueId);
+    return ((void *)(intptr_t)status);
+}
+
+static void check_payload(thrConfigs *thr, MessageQ_Msg msg, UInt16 msgId)
+{
+    uint32_t *slot = slot_ptr(thr, ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr);
+    unsigned int words = thr->payloadSize / sizeof(uint32_t);
+    long long start = nsecs();
+    uint32_t crc = payload_crc(slot, words);
+
+    thr->checkNs += nsecs() - start;
+    if (crc == ((RemoteBufSyncMsg *)msg)->crc) {
+        return;
+    }
+    if (thr->crcErrors++ == 0) {
+        printf("Thread [%d] : msg %d crc 0x%08x, expected 0x%08x, first bad word %d of %d\n",
+               thr->thread_num, msgId, crc, ((RemoteBufSyncMsg *)msg)->crc,
+               payload_first_bad(slot, words, payload_seed(thr->thread_num, msgId), msgId),
+               words);
+    }
+}
+
+/*
+ *  Stamps and checks message i of a receive stream, then hands it back to
+ *  a pooled sender or frees it. A message that is not message i is counted
+ *  and handed back unchecked: a pooled remote sender waits for every
+ *  message it sent to come back.
+ */
+static Int recv_msg(thrConfigs *thr, MessageQ_Msg msg, UInt16 i)
+{
+    MessageQ_QueueId returnQueueId;
+    long long start;
+    Int status;
+
+    ((RemoteBufSyncMsg *)msg)->recvTs = syncClock_read();
+    record_oneway(thr->latency, msg);
+    first_msg(thr);
+
+    /* Validate the returned message. */
+    if (MessageQ_getMsgId (msg) != i) {
+        printf ("Data integrity failure!\n"
+                "    Expected %d\n"
+                "    Received %d\n",
+                i, MessageQ_getMsgId (msg));
+        thr->idErrors++;
+        goto release;
+    }
+    if (buf_access(thr)) {
+        thr->syncNs += buf_begin(DMA_BUF_SYNC_READ);
+    }
+    if (thr->slots &&
+        !slot_check(slot_ptr(thr, ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr),
+                    thr->payloadSize, i)) {
+        thr->slotErrors++;
+    }
+    if (thr->check) {
+        check_payload(thr, msg, i);
+    }
+    if (thr->copy) {
+        start = nsecs();
+        thr->copyFxn(thr->copyBuf, thr->copy == COPY_INLINE ? MSG_INLINE(msg) :
+                     (void *)slot_ptr(thr, ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr),
+                     thr->payloadSize);
+        thr->copyNs += nsecs() - start;
+    }
+    if (buf_access(thr)) {
+        thr->syncNs += buf_end(DMA_BUF_SYNC_READ);
+    }
+
+release:
+    /* Pooled messages go back to the sender, the others are freed */
+    start = nsecs();
+    returnQueueId = MessageQ_getReplyQueue(msg);
+    if (returnQueueId != MessageQ_INVALIDMESSAGEQ) {
+        status = MessageQ_put(returnQueueId, msg);
+    }
+    else {
+        status = MessageQ_free (msg);
+    }
+    thr->acquireNs += nsecs() - start;
+    thr->msgsDone++;
+    return status;
+}
 
+static Void * pingThreadFxn_uni_recv(void *arg)
+{
+    struct thread_info pingThreadFxnData = *(struct thread_info *)arg;   
+    Int                      threadNum = 0;
+    Int32                    status     = 0;
+    MessageQ_Msg             msg        = NULL;
+    MessageQ_Params          msgParams;
+    UInt16                   i;
+    MessageQ_Handle          handle;
+    long long                cpuStart, loopStart;
+    thrConfigs               *thr = (thrConfigs *)arg;
+    unsigned int             drained = 0;
+
+    char             hostQueueName[64];
+
+    threadNum = pingThreadFxnData.thread_num;
+    sprintf(hostQueueName,   "%s_RECV_MQ_%d", A15_MESSAGEQNAME,  threadNum );
+
+    //printf("pingThreadFxn_uni_recv This thread num: %d from Name:%s  \n", threadNum,hostQueueName);
+    
     /* Create the local Message Queue for receiving. */
     MessageQ_Params_init (&msgParams);
     handle = MessageQ_create (hostQueueName, &msgParams);
@@ -655,180 +1537,2596 @@ Int dataTransactFxn(stProPerfConfig stExpConfig)
         printf ("Error in MessageQ_create\n");
         goto exit;
     }
-    /* Poll until remote side has it's messageQ created before we send: */
-    do {
-        status = MessageQ_open (remoteQueueName, &queueId);
-        sleep (1);
-    } while (status == MessageQ_E_NOTFOUND);
+#if PRINT_DEBUG
+    else {
+        printf ("thread: %d, Local Message: %s, QId: 0x%x\n",
+            threadNum, hostQueueName, MessageQ_getQueueId(handle));
+    }
+#endif
+    placement_start(thr);
+    cpuStart = thread_cpu_ns();
+    loopStart = nsecs();
+    for (i = 0 ; i < pingThreadFxnData.numMessages ; i++) {
+        /* drain up to batch messages before waiting again */
+        if (drained > 0 && drained < thr->batch &&
+            MessageQ_get(handle, &msg, 0) == MessageQ_S_SUCCESS) {
+            status = MessageQ_S_SUCCESS;
+            drained++;
+        }
+        else {
+            status = recv_get(handle, &msg, thr);
+            thr->wakeups++;
+            drained = 1;
+        }
+        if (drained > thr->maxDrain) {
+            thr->maxDrain = drained;
+        }
+        if (status < 0) {
+            printf ("Error in MessageQ_get [0x%x]\n", status);
+            break;
+        }
+        else {
+            placement_update(thr);
+            status = recv_msg(thr, msg, i);
+            if (status < 0) {
+                break;
+            }
+       }
+    }
+    thr->activeNs = nsecs() - loopStart;
+    thr->cpuNs = thread_cpu_ns() - cpuStart;
+
+    /* Clean-up */
+    status = MessageQ_delete (&handle);
+    if (status < 0) {
+        printf ("Error in MessageQ_delete [0x%x]\n", status);
+    }
+
+exit:
+    return ((void *)(intptr_t)status);
+}
+
+/*
+ *  Round trip (direction=2). Up to outstanding messages are kept in
+ *  flight to an echo task on the remote core, which stamps recvTs and
+ *  puts each one back to our queue. The round trip is timed from just
+ *  before the put to the return of the message, and the stamps give an
+ *  A15->remote one-way sample as well. interval is the think time
+ *  between an echo and the next request; with outstanding > 1 echoes
+ *  arriving during that sleep wait for it, so use interval=0 there.
+ */
+static Void * pingThreadFxn_bidir(void *arg)
+{
+    Int32                    status     = 0;
+    MessageQ_Msg             msg        = NULL;
+    MessageQ_Params          msgParams;
+    MessageQ_Handle          handle;
+    MessageQ_QueueId         queueId = MessageQ_INVALIDMESSAGEQ;
+    MessageQ_Msg             *msgs = NULL;
+    long long                *sentNs = NULL;
+    long long                cpuStart, loopStart;
+    thrConfigs               *thr = (thrConfigs *)arg;
+    unsigned int             numFree = 0, sent = 0, done = 0;
+    UInt16                   id;
+
+    char             hostQueueName[64];
+    char             remoteQueueName[64];
+
+    sprintf(hostQueueName, "%s_PING_MQ_%d", A15_MESSAGEQNAME, thr->thread_num);
+    sprintf(remoteQueueName, "%s_PING_MQ_%d", M4_MESSAGEQNAME, thr->thread_num);
+
+    MessageQ_Params_init (&msgParams);
+    handle = MessageQ_create (hostQueueName, &msgParams);
+    if (handle == NULL) {
+        printf ("Error in MessageQ_create\n");
+        return ((void *)-1);
+    }
+
+    msgs = calloc(thr->outstanding, sizeof(MessageQ_Msg));
+    sentNs = calloc(thr->outstanding, sizeof(long long));
+    if (msgs == NULL || sentNs == NULL) {
+        printf ("Error: no memory for %d outstanding messages\n",
+                thr->outstanding);
+        status = -1;
+        goto exit;
+    }
+    for (numFree = 0; numFree < thr->outstanding; numFree++) {
+        msg = MessageQ_alloc (HEAPID, sizeof(RemoteBufSyncMsg));
+        if (msg == NULL) {
+            printf ("Error in MessageQ_alloc\n");
+            status = -1;
+            goto exit;
+        }
+        MessageQ_setReplyQueue(handle, msg);
+        ((RemoteBufSyncMsg *)msg)->boBufPayloadPtr = thr->boBufPayloadPtr;
+        ((RemoteBufSyncMsg *)msg)->boBufPayloadSize = thr->boBufPayloadSize;
+        msgs[numFree] = msg;
+    }
+
+    /* Wait until remote side has it's messageQ created before we send: */
+    status = remote_open(remoteQueueName, &queueId, &thr->openNs, &thr->opens);
     if (status < 0) {
         printf ("Error in MessageQ_open [0x%x]\n", status);
-        goto cleanup;
+        goto exit;
     }
 
-    /* Allocate message. */
-    msg1 = MessageQ_alloc (HEAPID, sizeof(RemoteBufSyncMsg));
-    if (msg1 == NULL) {
-        printf ("Error in MessageQ_alloc\n");
-        goto cleanup;
+    placement_start(thr);
+    cpuStart = thread_cpu_ns();
+    loopStart = nsecs();
+    while (done < thr->numMessages) {
+        /* keep the window full */
+        if (sent < thr->numMessages && numFree > 0) {
+            msg = msgs[--numFree];
+            MessageQ_setMsgId (msg, sent);
+            ((RemoteBufSyncMsg *)msg)->recvTs = 0;
+            ((RemoteBufSyncMsg *)msg)->sendTs = syncClock_read();
+            sentNs[sent % thr->outstanding] = nsecs();
+            status = MessageQ_put (queueId, msg);
+            if (status < 0) {
+                printf ("Error in MessageQ_put [0x%x]\n", status);
+                break;
+            }
+            sent++;
+            continue;
+        }
+
+        status = recv_get(handle, &msg, thr);
+        if (status < 0) {
+            printf ("Error in MessageQ_get [0x%x]\n", status);
+            break;
+        }
+        thr->wakeups++;
+        id = MessageQ_getMsgId (msg);
+        /* replies are in order; the 16-bit msgId wraps, done does not */
+        hist_add(thr->rtt, nsecs() - sentNs[done % thr->outstanding]);
+        record_oneway(thr->latency, msg);
+        placement_update(thr);
+        msgs[numFree++] = msg;
+
+        /* echoes come back in order */
+        if (id != (UInt16)done) {
+            printf ("Data integrity failure!\n"
+                    "    Expected %d\n"
+                    "    Received %d\n",
+                    (UInt16)done, id);
+            thr->idErrors++;
+            status = -1;
+            break;
+        }
+        done++;
+        first_msg(thr);
+        thr->msgsDone++;
+
+        if (thr->numWaitTime && sent < thr->numMessages) {
+            usleep (thr->numWaitTime);
+        }
     }
+    thr->activeNs = nsecs() - loopStart;
+    thr->cpuNs = thread_cpu_ns() - cpuStart;
 
-    MessageQ_setMsgId (msg1, 1);/* Set a random number to associate with this message*/
+    MessageQ_close (&queueId);
+
+exit:
+    /* messages still in flight are lost with the queue */
+    while (numFree > 0) {
+        MessageQ_free (msgs[--numFree]);
+    }
+    free(msgs);
+    free(sentNs);
+    MessageQ_delete (&handle);
+    return ((void *)(intptr_t)status);
+}
+
+
+/*
+ *  Reactor mode (-r N)
+ *
+ *  Instead of a thread per stream, N event loops each drive a share of
+ *  the one-way streams, loop k pinned to CPU k modulo the CPUs present.
+ *  MessageQ has no descriptor to wait on, so a loop polls its receive
+ *  queues and pool return queues with non-blocking gets, and sleeps to
+ *  the next wheel tick when a pass found nothing to do. Senders are paced
+ *  by a hashed timer wheel on the same schedules as the sender threads;
+ *  a sender behind its schedule skips the wheel and goes again in the
+ *  same pass, so it catches up as a thread would. pace=0 runs as pace=1.
+ *  Round trip streams keep their own thread and the per-stream policy,
+ *  prio and cpu keys do not apply.
+ */
+#define REACTOR_TICK_US         50
+#define REACTOR_TICK_NS         (REACTOR_TICK_US * 1000LL)
+#define REACTOR_WHEEL_SLOTS     256
+
+typedef struct RStream {
+    thrConfigs *thr;
+    MessageQ_Handle handle; /* Receive streams */
+    MessageQ_QueueId queueId; /* Send streams */
+    MsgPool pool;
+    Pacer pacer;
+    long long due; /* Intended time of the next batch */
+    long long tick; /* Intended time of the batch being sent */
+    long long stallStart; /* Waiting for a pool message since, 0 = not */
+    unsigned int next; /* Messages handled so far */
+    unsigned int inBatch; /* Messages of the current batch already put */
+    int ready; /* Off the wheel, sending a batch */
+    int done;
+    struct RStream *wheelNext;
+} RStream;
+
+typedef struct Reactor {
+    pthread_t thread_id;
+    int num;
+    int cpu;
+    RStream *streams;
+    unsigned int numStreams;
+    unsigned int numLeft;
+    RStream *wheel[REACTOR_WHEEL_SLOTS];
+    long long wheelTick; /* Next tick to expire */
+    unsigned long long passes;
+    unsigned long long sleeps; /* Passes that found nothing to do */
+    unsigned long long timers; /* Batches released by the wheel */
+    unsigned long long msgs;
+    long long cpuNs;
+    long long activeNs;
+    Int status;
+} Reactor;
+
+/* Takes the batch's tick, kept until the whole batch is out */
+static void rstream_release(RStream *s)
+{
+    s->ready = 1;
+    s->tick = pacer_next(&s->pacer);
+}
+
+static void wheel_add(Reactor *r, RStream *s)
+{
+    long long tick = s->due / REACTOR_TICK_NS;
+    RStream **slot;
+
+    /* overdue batches go out on the next expiry */
+    if (tick < r->wheelTick) {
+        tick = r->wheelTick;
+    }
+    slot = &r->wheel[tick % REACTOR_WHEEL_SLOTS];
+    s->wheelNext = *slot;
+    *slot = s;
+}
+
+/* Expires the ticks up to now, streams due by then become ready */
+static void wheel_expire(Reactor *r, long long now)
+{
+    long long nowTick = now / REACTOR_TICK_NS;
+    RStream **slot, *list, *s;
+
+    while (r->wheelTick <= nowTick) {
+        slot = &r->wheel[r->wheelTick % REACTOR_WHEEL_SLOTS];
+        list = *slot;
+        *slot = NULL;
+        while (list != NULL) {
+            s = list;
+            list = s->wheelNext;
+            if (s->due / REACTOR_TICK_NS <= nowTick) {
+                rstream_release(s);
+                r->timers++;
+            }
+            else {
+                /* a later turn of the wheel */
+                s->wheelNext = *slot;
+                *slot = s;
+            }
+        }
+        r->wheelTick++;
+    }
+}
+
+/* When the wheel next has work, at most one turn ahead */
+static long long wheel_next(Reactor *r)
+{
+    unsigned int i;
+
+    for (i = 0; i < REACTOR_WHEEL_SLOTS; i++) {
+        if (r->wheel[(r->wheelTick + i) % REACTOR_WHEEL_SLOTS] != NULL) {
+            break;
+        }
+    }
+    return (r->wheelTick + i) * REACTOR_TICK_NS;
+}
+
+static void rstream_done(Reactor *r, RStream *s, long long loopStart)
+{
+    s->done = 1;
+    s->thr->activeNs = nsecs() - loopStart;
+    r->numLeft--;
+}
+
+/* Puts what it can of a due batch, returns the messages sent */
+static unsigned int rstream_send(Reactor *r, RStream *s, long long now, long long loopStart)
+{
+    thrConfigs *thr = s->thr;
+    MessageQ_Msg msg;
+    long long start;
+    unsigned int sent = 0;
+    Int status;
+
+    if (s->inBatch == 0 && s->due > now) {
+        return 0;
+    }
+
+    while (s->ready) {
+        start = nsecs();
+        if (thr->poolSize) {
+            msg = MsgPool_poll(&s->pool);
+            if (msg == NULL) {
+                if (s->stallStart == 0) {
+                    s->pool.exhausted++;
+                    s->stallStart = start;
+                }
+                break;
+            }
+            if (s->stallStart) {
+                s->pool.waitNs += start - s->stallStart;
+                s->stallStart = 0;
+            }
+        }
+        else {
+            msg = MessageQ_alloc (HEAPID, msg_size(thr));
+        }
+        thr->acquireNs += nsecs() - start;
+        if (msg == NULL) {
+            printf ("Error in MessageQ_alloc\n");
+            r->status = -1;
+            rstream_done(r, s, loopStart);
+            break;
+        }
+
+        status = send_msg(thr, s->queueId, msg, s->next,
+                          s->tick - (thr->batch - 1 - s->inBatch) * thr->numWaitTime * 1000LL);
+        if (status < 0) {
+            printf ("Error in MessageQ_put [0x%x]\n", status);
+            r->status = status;
+            rstream_done(r, s, loopStart);
+            break;
+        }
+        sent++;
+        s->next++;
+        s->inBatch++;
+
+        if (s->inBatch == thr->batch || s->next == thr->numMessages) {
+            hist_add(thr->sendLag, nsecs() - s->tick);
+            s->inBatch = 0;
+            s->ready = 0;
+            if (s->next == thr->numMessages) {
+                rstream_done(r, s, loopStart);
+            }
+            else {
+                s->due = s->pacer.next;
+                if (s->due <= nsecs()) {
+                    /* behind: stays off the wheel and goes again this pass */
+                    rstream_release(s);
+                }
+                else {
+                    wheel_add(r, s);
+                }
+            }
+            break;
+        }
+    }
+    return sent;
+}
+
+/* Handles up to batch waiting messages, returns how many */
+static unsigned int rstream_recv(Reactor *r, RStream *s, long long loopStart)
+{
+    thrConfigs *thr = s->thr;
+    MessageQ_Msg msg;
+    unsigned int drained = 0;
+
+    while (drained < thr->batch &&
+           MessageQ_get(s->handle, &msg, 0) == MessageQ_S_SUCCESS) {
+        drained++;
+        if (recv_msg(thr, msg, s->next) < 0) {
+            r->status = -1;
+            rstream_done(r, s, loopStart);
+            return drained;
+        }
+        if (++s->next == thr->numMessages) {
+            rstream_done(r, s, loopStart);
+            break;
+        }
+    }
+    if (drained) {
+        thr->wakeups++;
+        if (drained > thr->maxDrain) {
+            thr->maxDrain = drained;
+        }
+    }
+    return drained;
+}
+
+static Int rstream_open(RStream *s)
+{
+    thrConfigs *thr = s->thr;
+    MessageQ_Params msgParams;
+    char name[64];
+    Int status;
+
+    if (thr->config_param == unidirectional_recv) {
+        sprintf(name, "%s_RECV_MQ_%d", A15_MESSAGEQNAME, thr->thread_num);
+        MessageQ_Params_init (&msgParams);
+        s->handle = MessageQ_create (name, &msgParams);
+        if (s->handle == NULL) {
+            printf ("Error in MessageQ_create %s\n", name);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (thr->poolSize) {
+        sprintf(name, "%s_POOL_%d", A15_MESSAGEQNAME, thr->thread_num);
+        if (MsgPool_create(&s->pool, thr->poolSize, msg_size(thr), name) < 0) {
+            return -1;
+        }
+        s->pool.latency = thr->latency;
+        if (thr->slots) {
+            slot_bind(&s->pool, thr);
+        }
+    }
+
+    sprintf(name, "%s_RECV_MQ_%d", M4_MESSAGEQNAME, thr->thread_num);
+    status = remote_open(name, &s->queueId, &thr->openNs, &thr->opens);
+    if (status < 0) {
+        printf ("Error in MessageQ_open [0x%x]\n", status);
+    }
+    return status;
+}
+
+static void rstream_close(RStream *s)
+{
+    thrConfigs *thr = s->thr;
+
+    if (thr->config_param == unidirectional_recv) {
+        if (s->handle != NULL) {
+            MessageQ_delete (&s->handle);
+        }
+        return;
+    }
+
+    if (thr->poolSize) {
+        thr->poolExhausted = s->pool.exhausted;
+        thr->poolLowWater = s->pool.lowWater;
+        thr->poolWaitUs = s->pool.waitNs / 1000;
+        MsgPool_delete(&s->pool);
+    }
+    if (s->queueId != MessageQ_INVALIDMESSAGEQ) {
+        MessageQ_close (&s->queueId);
+    }
+}
+
+static Void * reactorFxn(void *arg)
+{
+    Reactor *r = (Reactor *)arg;
+    RStream *s;
+    struct timespec ts;
+    long long now, wake, due, nextTick, cpuStart, loopStart;
+    unsigned int i, work, sent;
+    int again;
+
+    /* receive queues first, the remote senders are waiting for them */
+    for (i = 0; i < r->numStreams; i++) {
+        s = &r->streams[i];
+        if (s->thr->config_param == unidirectional_recv && rstream_open(s) < 0) {
+            r->status = -1;
+            goto exit;
+        }
+    }
+    for (i = 0; i < r->numStreams; i++) {
+        s = &r->streams[i];
+        if (s->thr->config_param == unidirectional_send && rstream_open(s) < 0) {
+            r->status = -1;
+            goto exit;
+        }
+    }
+
+    if (r->numStreams) {
+        placement_start(r->streams[0].thr);
+    }
+    cpuStart = thread_cpu_ns();
+    loopStart = nsecs();
+    r->wheelTick = loopStart / REACTOR_TICK_NS;
+    r->numLeft = r->numStreams;
+    for (i = 0; i < r->numStreams; i++) {
+        s = &r->streams[i];
+        if (s->thr->numMessages == 0) {
+            rstream_done(r, s, loopStart);
+        }
+        else if (s->thr->config_param == unidirectional_send) {
+            pacer_init(&s->pacer, s->thr);
+            if (s->pacer.mode == PACE_SLEEP) {
+                s->pacer.mode = PACE_CONSTANT;
+            }
+            s->due = s->pacer.next;
+            wheel_add(r, s);
+        }
+    }
+
+    while (r->numLeft) {
+        r->passes++;
+        now = nsecs();
+        wheel_expire(r, now);
+
+        work = 0;
+        wake = wheel_next(r);
+        nextTick = (now / REACTOR_TICK_NS + 1) * REACTOR_TICK_NS;
+        /* a batch at a time per stream, round again while any is behind */
+        do {
+            again = 0;
+            for (i = 0; i < r->numStreams; i++) {
+                s = &r->streams[i];
+                if (s->done) {
+                    continue;
+                }
+                if (s->thr->config_param == unidirectional_recv) {
+                    work += rstream_recv(r, s, loopStart);
+                    /* nothing tells us a message has come, poll next tick */
+                    due = nextTick;
+                }
+                else if (s->ready) {
+                    sent = rstream_send(r, s, now, loopStart);
+                    work += sent;
+                    if (sent && s->ready && !s->done) {
+                        again = 1;
+                    }
+                    /* not due yet or out of pool messages */
+                    due = s->stallStart ? nextTick : s->due;
+                }
+                else {
+                    continue;
+                }
+                if (!s->done && due < wake) {
+                    wake = due;
+                }
+            }
+            now = nsecs();
+        } while (again && r->numLeft);
+        r->msgs += work;
+
+        /* no sleeping while a stream is past due */
+        if (work == 0 && r->numLeft && wake > now) {
+            placement_update(r->streams[0].thr);
+            r->sleeps++;
+            ts.tv_sec = wake / 1000000000LL;
+            ts.tv_nsec = wake % 1000000000LL;
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+                ;
+        }
+    }
+    r->activeNs = nsecs() - loopStart;
+    r->cpuNs = thread_cpu_ns() - cpuStart;
+
+    /* every stream ran on this thread */
+    for (i = 1; i < r->numStreams; i++) {
+        thrConfigs *thr = r->streams[i].thr, *first = r->streams[0].thr;
+
+        thr->runPolicy = first->runPolicy;
+        thr->runPrio = first->runPrio;
+        thr->cpuFirst = first->cpuFirst;
+        thr->cpuLast = first->cpuLast;
+        thr->migrations = first->migrations;
+        strcpy(thr->allowed, first->allowed);
+    }
+
+exit:
+    for (i = 0; i < r->numStreams; i++) {
+        rstream_close(&r->streams[i]);
+    }
+    return ((void *)(intptr_t)r->status);
+}
+
+static void reactor_free(Reactor *loops, int numLoops)
+{
+    int i;
+
+    for (i = 0; loops && i < numLoops; i++) {
+        free(loops[i].streams);
+    }
+    free(loops);
+}
+
+/* Deals the one-way streams out to numLoops loops and starts them */
+static Reactor *reactor_start(stProPerfConfig *cfg, int numLoops)
+{
+    Reactor *loops;
+    pthread_attr_t attr;
+    cpu_set_t cpus;
+    int i, k, n = 0, ret;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    loops = calloc(numLoops, sizeof(Reactor));
+    if (loops == NULL) {
+        return NULL;
+    }
+    for (k = 0; k < numLoops; k++) {
+        loops[k].num = k;
+        loops[k].cpu = k % (ncpu > 0 ? ncpu : 1);
+        loops[k].streams = calloc(cfg->numThreads / numLoops + 1, sizeof(RStream));
+        if (loops[k].streams == NULL) {
+            reactor_free(loops, k);
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < cfg->numThreads; i++) {
+        thrConfigs *thr = &cfg->pThrConfig[i];
+        RStream *s;
+
+        if (thr->reactor < 0) {
+            continue;
+        }
+        k = n++ % numLoops;
+        thr->reactor = k;
+        s = &loops[k].streams[loops[k].numStreams++];
+        s->thr = thr;
+        s->queueId = MessageQ_INVALIDMESSAGEQ;
+    }
+
+    for (k = 0; k < numLoops; k++) {
+        pthread_attr_init(&attr);
+        CPU_ZERO(&cpus);
+        CPU_SET(loops[k].cpu, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+        ret = pthread_create(&loops[k].thread_id, &attr, &reactorFxn, &loops[k]);
+        pthread_attr_destroy(&attr);
+        if (ret) {
+            printf("MessageQMulti: can't spawn reactor: %d, %s\n", k, strerror(ret));
+            loops[k].status = -1;
+            loops[k].thread_id = 0;
+        }
+    }
+    return loops;
+}
+
+static double tv_ms(const struct timeval *tv)
+{
+    return tv->tv_sec * 1000.0 + tv->tv_usec / 1000.0;
+}
+
+static void print_reactors(Reactor *loops, int numLoops)
+{
+    Reactor *r;
+    int k;
+
+    printf("\n%-6s %4s %8s %10s %10s %7s %10s %10s %7s\n", "Loop", "CPU",
+           "Streams", "Messages", "Passes", "Idle%", "Timers", "cpu ms", "Busy%");
+    for (k = 0; k < numLoops; k++) {
+        r = &loops[k];
+        printf("%-6d %4d %8d %10llu %10llu %6.1f%% %10llu %10.1f %6.1f%%\n", r->num,
+               r->cpu, r->numStreams, r->msgs, r->passes,
+               r->passes ? 100.0 * r->sleeps / r->passes : 0.0, r->timers,
+               r->cpuNs / 1000000.0,
+               r->activeNs ? 100.0 * r->cpuNs / r->activeNs : 0.0);
+    }
+}
+
+Int dataTransactFxn(stProPerfConfig stExpConfig)
+{
+    Int32                    status     = 0;
+    MessageQ_Msg             msg1        = NULL;
+    MessageQ_Params          msgParams;
+    Int32                    i;
+    MessageQ_Handle          handle;
+    MessageQ_QueueId         queueId = MessageQ_INVALIDMESSAGEQ;
+
+    char             remoteQueueName[64];
+    char             hostQueueName[64];
+
+    sprintf(remoteQueueName, "%s_%d", SLAVE_MESSAGEQNAME,0);
+    sprintf(hostQueueName,   "%s_%d", HOST_MESSAGEQNAME,0);
+
+    printf("dataTransactFxn: This function is a test to showcase data transaction\n");
+
+    /* Create the local Message Queue for receiving. */
+    MessageQ_Params_init (&msgParams);
+    handle = MessageQ_create (hostQueueName, &msgParams);
+    if (handle == NULL) {
+        printf ("Error in MessageQ_create\n");
+        goto exit;
+    }
+    /* Wait until remote side has it's messageQ created before we send: */
+    status = remote_open(remoteQueueName, &queueId, NULL, NULL);
+    if (status < 0) {
+        printf ("Error in MessageQ_open [0x%x]\n", status);
+        goto cleanup;
+    }
+
+    /* Allocate message. */
+    msg1 = MessageQ_alloc (HEAPID, sizeof(RemoteBufSyncMsg));
+    if (msg1 == NULL) {
+        printf ("Error in MessageQ_alloc\n");
+        goto cleanup;
+    }
+
+    MessageQ_setMsgId (msg1, 1);/* Set a random number to associate with this message*/
+
+    buf_begin(DMA_BUF_SYNC_WRITE);
+    for (i = 0; i < (stExpConfig.bufferPtrSize/sizeof(uint32_t)); i++) {
+        stExpConfig.bufferPtr[i] = 0xbeefdead;
+    }
+    buf_end(DMA_BUF_SYNC_WRITE);
+
+    /* Have the rem te proc reply to this message queue */
+    MessageQ_setReplyQueue (handle, msg1);
+    ((RemoteBufSyncMsg *)msg1)->boBufPayloadPtr = stExpConfig.bufferPtrRemoteAddr;
+    ((RemoteBufSyncMsg *)msg1)->boBufPayloadSize = stExpConfig.bufferPtrSize;
+
+    status = MessageQ_put (queueId, msg1);
+    if (status < 0) {
+        printf ("Error in MessageQ_put [0x%x]\n", status);
+        goto cleanup;
+    }
+
+    status = MessageQ_get(handle, &msg1, MessageQ_FOREVER);
+    if (status < 0) {
+       printf ("Error in MessageQ_get [0x%x]\n", status);
+       goto cleanup;
+    }
+    else {
+       buf_begin(DMA_BUF_SYNC_READ);
+       for (i = 0; i < (stExpConfig.bufferPtrSize/sizeof(uint32_t)); i++) {
+              if (stExpConfig.bufferPtr[i] != 0xdeadbeef) {
+              status = 1;
+              printf ("Data integrity failure!\n"
+                "    Expected %s\n"
+                "    Received 0x%x\n",
+                "0xdeadbeef", stExpConfig.bufferPtr[i]);
+              break;
+        }
+    }
+    buf_end(DMA_BUF_SYNC_READ);
+    if(status != 1)
+        printf("%s:Test Pass\n",__func__);
+    /* Validate the returned message. */
+    status = MessageQ_free (msg1);
+   }
+
+    MessageQ_close (&queueId);
+
+cleanup:
+    /* Clean-up */
+    status = MessageQ_delete (&handle);
+    if (status < 0) {
+        printf ("Error in MessageQ_delete [0x%x]\n", status);
+    }
+
+exit:
+    return status;
+}
+
+#define printd(fmt, ...) \
+	do { if (debug) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
+
+int debug=0;
+
+struct config
+{
+	int direction;
+	int interval;
+	int msgSize;
+	int msgCount;
+	int procID;
+	int pool;
+	int recv;
+	int spin;
+	int cpu;
+	int pace;
+	int burst;
+	int policy;
+	int prio;
+	int batch;
+	int slots;
+	int outstanding;
+	int check;
+	int copy;
+	int copyKernel;
+};
+
+struct config *xyz;
+int linecount = 0;
+static int configSize = 0;
+
+/* Makes room for line linecount and sets its defaults */
+static void config_next(void)
+{
+	struct config *grown;
+
+	if (linecount == configSize) {
+		grown = realloc(xyz, (configSize + CONFIG_CHUNK) * sizeof(struct config));
+		if (grown == NULL) {
+			printf("No memory for %d streams\n", configSize + CONFIG_CHUNK);
+			exit(1);
+		}
+		xyz = grown;
+		configSize += CONFIG_CHUNK;
+	}
+	memset(&xyz[linecount], 0, sizeof(struct config));
+	xyz[linecount].cpu = -1;
+	xyz[linecount].pace = PACE_CONSTANT;
+}
+
+char keylist[][50] = {
+	"direction",
+	"msgSize",
+	"msgCount",
+	"interval",
+	"procID",
+	"pool",
+	"recv",
+	"spin",
+	"cpu",
+	"pace",
+	"burst",
+	"policy",
+	"prio",
+	"batch",
+	"slots",
+	"outstanding",
+	"check",
+	"copy",
+	"memcpy"
+};
+
+int validatekey(char *ptr)
+{
+	int i;
+	for(i=0; i<sizeof(keylist)/sizeof(keylist[0]); i++)
+		if(strcmp(ptr, keylist[i]) == 0)
+			return 0;
+
+	return 1;
+}
+
+/*
+direction: 0-Send, 1-Recv
+msgSize: in bytes(Should be 4 bytes aligned)
+msgCount: number of messages to be exchanged
+interval: in microsecs(us)
+procID: core, Hardcoded to IPU2 for the time being
+pool: optional, number of messages the sender of this stream allocates up
+      front and recycles; 0 (default) allocates and frees every message
+recv: optional, receive strategy of a receiver: 0 (default) blocks in
+      MessageQ_get, 1 busy-polls, 2 polls for spin us and then blocks
+spin: optional, poll budget in us for recv=1/2 (default 50)
+cpu: optional, pins the thread to this CPU
+pace: optional, sender pacing: 0 sleeps interval after each put, 1
+      (default) one message every interval on an absolute schedule,
+      2 Poisson arrivals with a mean gap of interval, 3 bursts
+burst: optional, messages per burst for pace=3, sent every burst*interval
+policy: optional, scheduling policy: 0 SCHED_OTHER (default), 1 SCHED_FIFO,
+        2 SCHED_RR; 1 and 2 need root or CAP_SYS_NICE
+prio: optional, static priority 1-99 for policy=1/2
+batch: optional, the sender puts batch messages per wakeup, batch*interval
+       apart, and the receiver drains up to batch messages before it
+       waits again; default 1
+slots: optional, ring of slots payload buffers for the stream, passed
+       between sender and receiver with the messages as credits
+copy: optional, 0 (default) zero copy, 1 payload in the message body,
+      2 payload copied through the shared buffer
+memcpy: optional, host copy kernel for copy=1/2: 0 libc (default), 1 SIMD,
+        2 non-temporal stores
+
+Sample contents of cfg file:");
+
+#Thread 1
+direction=0, msgSize=6400, msgCount=400, interval=2500, procID=1
+#Thread 2
+direction=1, msgSize=640, msgCount=800, interval=2500, procID=1
+
+*/
+#define PRINTEXIT {printusage(); exit(1);}
+
+void printusage() {
+    printf("\n --------------------------------------------");
+    printf("\n INCORRECT USAGE !");
+    printf("\n --------------------------------------------");
+    printf("\n ./MessageQZCpy -f <CFG file path> [-j <results.json>] [-r <loops>] [-b wc|cached]");
+    printf("\n                [-s <sweep> [-w <msgs>]] [-m <MmRpc bench> [-w <calls>]]");
+    printf("\n");
+    printf("\n -f : MANDATORY  : Configuration file which contains use-case configurations");
+    printf("\n -j : OPTIONAL   : JSON results file [MessageQZCpy.json]");
+    printf("\n -b : OPTIONAL   : shared buffer write-combined (default) or cached with");
+    printf("\n                   DMA-BUF sync around every CPU access");
+    printf("\n -r : OPTIONAL   : drive the one-way streams from N event loops instead of");
+    printf("\n                   a thread each, loop k pinned to CPU k");
+    printf("\n -s : OPTIONAL   : sweep, runs the cfg at every combination of key=range,...");
+    printf("\n                   in one IPC session, e.g. \"msgSize=64:4096:x4,threads=1:4\"");
+    printf("\n                   range: first:last[:xN|+N] or a|b|c, keys: cfg keys, threads, loops");
+    printf("\n -m : OPTIONAL   : MmRpc call benchmark instead of the streams, a grid as for -s");
+    printf("\n                   of params=1-%d, xlts=0-%d, size=bytes per buffer, calls",
+           MX_BENCH_MAX_PARAMS, MX_BENCH_MAX_XLTS);
+    printf("\n                   [1, 1, %d, %d], e.g. \"params=1:8:x2,size=0|64|4096\"",
+           RPC_BENCH_SIZE, RPC_BENCH_CALLS);
+    printf("\n -w : OPTIONAL   : warm-up messages per stream before each sweep point");
+    printf("\n                   [10%% of msgCount], 0 for none; calls for -m [10%%]");
+    printf("\n");
+    printf("\n Sample contents of cfg file:");
+    printf("\n #Thread 1");
+    printf("\n direction=0, msgSize=6400, msgCount=400, interval=2500, procID=1");
+    printf("\n #Thread 2");
+    printf("\n direction=1, msgSize=640, msgCount=800, interval=2500, procID=1");
+    printf("\n #Thread 3, round trips");
+    printf("\n direction=2, msgSize=640, msgCount=800, interval=0, procID=1, outstanding=4");
+    printf("\n");
+    printf("\n Optional keys:");
+    printf("\n pool=N : sender preallocates N messages and recycles them");
+    printf("\n recv=0|1|2 : receiver blocks (0), busy-polls (1) or polls then blocks (2)");
+    printf("\n spin=US : poll budget for recv=1/2 [%d]", DEFAULT_SPIN_US);
+    printf("\n cpu=N : pin the thread to CPU N");
+    printf("\n pace=0|1|2|3 : sleep after put, constant rate (default), Poisson or bursts");
+    printf("\n burst=N : messages per burst for pace=3");
+    printf("\n policy=0|1|2 : SCHED_OTHER (default), SCHED_FIFO or SCHED_RR");
+    printf("\n prio=N : priority 1-99 for policy=1/2");
+    printf("\n batch=N : send N messages per wakeup, drain up to N per wakeup");
+    printf("\n slots=K : ring of K payload buffers handed over with credits");
+    printf("\n outstanding=N : round trips in flight for direction=2 [1]");
+    printf("\n check=1 : seeded payload pattern with a CRC32C per message, on a ring");
+    printf("\n copy=0|1|2 : zero copy (default), payload in the message (up to %d bytes)",
+           (int)COPY_INLINE_MAX);
+    printf("\n              or copied in and out of the shared buffer");
+    printf("\n memcpy=0|1|2 : copy kernel for copy=1/2: libc (default), SIMD or non-temporal");
+    printf("\n");
+}
+
+
+static void config_set(struct config *c, const char *key, int value)
+{
+	printd("%s", "Inside config_set\n");
+	
+	if(strcmp(key, "direction") == 0)
+		c->direction = value;
+	else if(strcmp(key, "interval") == 0)
+		c->interval = value;
+	else if(strcmp(key, "msgSize") == 0)
+		c->msgSize = value;
+	else if(strcmp(key, "msgCount") == 0)
+		c->msgCount = value;
+	else if(strcmp(key, "procID") == 0)
+		c->procID = value;
+	else if(strcmp(key, "pool") == 0)
+		c->pool = value;
+	else if(strcmp(key, "recv") == 0)
+		c->recv = value;
+	else if(strcmp(key, "spin") == 0)
+		c->spin = value;
+	else if(strcmp(key, "cpu") == 0)
+		c->cpu = value;
+	else if(strcmp(key, "pace") == 0)
+		c->pace = value;
+	else if(strcmp(key, "burst") == 0)
+		c->burst = value;
+	else if(strcmp(key, "policy") == 0)
+		c->policy = value;
+	else if(strcmp(key, "prio") == 0)
+		c->prio = value;
+	else if(strcmp(key, "batch") == 0)
+		c->batch = value;
+	else if(strcmp(key, "slots") == 0)
+		c->slots = value;
+	else if(strcmp(key, "outstanding") == 0)
+		c->outstanding = value;
+	else if(strcmp(key, "check") == 0)
+		c->check = value;
+	else if(strcmp(key, "copy") == 0)
+		c->copy = value;
+	else if(strcmp(key, "memcpy") == 0)
+		c->copyKernel = value;
+	else
+		printd("%s", "********** UNKNOWN**********");
+}
+
+static const char *direction_name(const thrConfigs *thr)
+{
+    return thr->config_param == unidirectional_send ? "A15->remote" :
+           thr->config_param == bidirectional ? "A15<->remote" : "remote->A15";
+}
+
+/* Per-message cost over the messages actually done; a stream can stop early */
+static long long per_msg(const thrConfigs *thr, long long ns)
+{
+    return thr->msgsDone ? ns / thr->msgsDone : 0;
+}
+
+static void print_latency_row(const char *name, const thrConfigs *thr, const Hist *h)
+{
+    printf("%-8s %-12s %8d %6d %9llu %9.1f %9.1f %9.1f %9.1f\n", name,
+           direction_name(thr), thr->payloadSize, thr->batch, (unsigned long long)h->count,
+           hist_percentile(h, 50) / 1000.0, hist_percentile(h, 99) / 1000.0,
+           hist_percentile(h, 99.9) / 1000.0, h->max / 1000.0);
+}
+
+static int same_stream_kind(const thrConfigs *a, const thrConfigs *b)
+{
+    return a->config_param == b->config_param &&
+           a->payloadSize == b->payloadSize && a->batch == b->batch;
+}
+
+/*
+ *  One-way latency per thread, then merged per direction, payload size
+ *  and batch.
+ *  Senders only get samples in pooled mode, where messages come back with
+ *  the receive stamp.
+ */
+static void print_latency(stProPerfConfig *stExpConfig)
+{
+    thrConfigs *thr = stExpConfig->pThrConfig;
+    Hist merged;
+    char name[16];
+    int i, j, done;
+
+    if (syncCounter) {
+        printf("\nOne-way latency in usecs (32K sync counter, %.1f us resolution)\n",
+               1000000.0 / SYNC_COUNTER_HZ);
+    }
+    else {
+        printf("\nOne-way latency in usecs (CLOCK_MONOTONIC)\n");
+    }
+    printf("%-8s %-12s %8s %6s %9s %9s %9s %9s %9s\n", "Thread", "Direction",
+           "Size", "Batch", "Count", "p50", "p99", "p99.9", "max");
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        if (thr[i].latency->count) {
+            sprintf(name, "%d", thr[i].thread_num);
+            print_latency_row(name, &thr[i], thr[i].latency);
+        }
+    }
+
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        /* first thread of each kind does the merge */
+        for (done = 0, j = 0; j < i && !done; j++) {
+            done = same_stream_kind(&thr[j], &thr[i]);
+        }
+        if (done) {
+            continue;
+        }
+
+        hist_init(&merged);
+        for (j = i; j < stExpConfig->numThreads; j++) {
+            if (same_stream_kind(&thr[j], &thr[i])) {
+                hist_merge(&merged, thr[j].latency);
+            }
+        }
+        if (merged.count) {
+            print_latency_row("all", &thr[i], &merged);
+        }
+    }
+    printf("\n");
+}
+
+static void print_rtt_row(const char *name, const thrConfigs *thr, const Hist *h)
+{
+    printf("%-8s %8d %6d %9llu %9.1f %9.1f %9.1f %9.1f %9.1f\n", name,
+           thr->payloadSize, thr->outstanding, (unsigned long long)h->count,
+           hist_percentile(h, 50) / 1000.0, hist_percentile(h, 99) / 1000.0,
+           hist_percentile(h, 99.9) / 1000.0, h->max / 1000.0,
+           hist_mean(h) / 1000.0);
+}
+
+/*
+ *  Round trip time of the direction=2 threads, per thread and then merged
+ *  per payload size and number of messages in flight.
+ */
+static void print_rtt(stProPerfConfig *stExpConfig)
+{
+    thrConfigs *thr = stExpConfig->pThrConfig;
+    Hist merged;
+    char name[16];
+    int i, j, done;
+
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        if (thr[i].rtt->count) {
+            break;
+        }
+    }
+    if (i == stExpConfig->numThreads) {
+        return;
+    }
+
+    printf("Round trip time in usecs (CLOCK_MONOTONIC)\n");
+    printf("%-8s %8s %6s %9s %9s %9s %9s %9s %9s\n", "Thread", "Size",
+           "Outst", "Count", "p50", "p99", "p99.9", "max", "mean");
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        if (thr[i].rtt->count) {
+            sprintf(name, "%d", thr[i].thread_num);
+            print_rtt_row(name, &thr[i], thr[i].rtt);
+        }
+    }
+
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        if (!thr[i].rtt->count) {
+            continue;
+        }
+        for (done = 0, j = 0; j < i && !done; j++) {
+            done = thr[j].rtt->count && thr[j].payloadSize == thr[i].payloadSize &&
+                   thr[j].outstanding == thr[i].outstanding;
+        }
+        if (done) {
+            continue;
+        }
+
+        hist_init(&merged);
+        for (j = i; j < stExpConfig->numThreads; j++) {
+            if (thr[j].payloadSize == thr[i].payloadSize &&
+                thr[j].outstanding == thr[i].outstanding) {
+                hist_merge(&merged, thr[j].rtt);
+            }
+        }
+        print_rtt_row("all", &thr[i], &merged);
+    }
+    printf("\n");
+}
+
+static double bringup_ms(long long t)
+{
+    return t ? (t - bringup.start) / 1000000.0 : 0.0;
+}
+
+/* The earliest first message of all streams */
+static long long first_msg_of(stProPerfConfig *cfg)
+{
+    long long first = 0;
+    int i;
+
+    for (i = 0; i < cfg->numThreads; i++) {
+        if (cfg->pThrConfig[i].firstNs &&
+            (first == 0 || cfg->pThrConfig[i].firstNs < first)) {
+            first = cfg->pThrConfig[i].firstNs;
+        }
+    }
+    return first;
+}
+
+/*
+ *  IPC bring-up from process start, then per stream the wait for its remote
+ *  queue and its first message after the streams were launched.
+ */
+static void print_startup(stProPerfConfig *cfg)
+{
+    thrConfigs *thr;
+    int i;
+
+    printf("Start-up in ms from process start: Ipc_start %.2f, MmRpc %.2f, "
+           "remote queue %.2f (MessageQ_open x%u), handshake %.2f, first message %.2f\n",
+           bringup_ms(bringup.ipc), bringup_ms(bringup.rpc), bringup_ms(bringup.ready),
+           bringup.opens, bringup_ms(bringup.handshake), bringup_ms(first_msg_of(cfg)));
+    printf("%-8s %-12s %9s %6s %12s\n", "Thread", "Direction", "Open ms", "Opens",
+           "First msg ms");
+    for (i = 0; i < cfg->numThreads; i++) {
+        thr = &cfg->pThrConfig[i];
+        printf("%-8d %-12s ", thr->thread_num, direction_name(thr));
+        if (thr->opens) {
+            printf("%9.2f %6u ", thr->openNs / 1000000.0, thr->opens);
+        }
+        else {
+            printf("%9s %6s ", "-", "-");
+        }
+        if (thr->firstNs) {
+            printf("%12.2f\n", (thr->firstNs - bringup.launch) / 1000000.0);
+        }
+        else {
+            printf("%12s\n", "-");
+        }
+    }
+    printf("\n");
+}
+
+/*
+ *  Per-message cost of the host's accesses to the shared buffer: writing
+ *  the payload on a sender (check fill or copy=2), DMA-BUF sync around it
+ *  with a cached buffer, reading it on a receiver (check verify or copy=2).
+ *  Slot tags alone are not timed.
+ */
+static void print_buffer(stProPerfConfig *stExpConfig)
+{
+    thrConfigs *thr;
+    long long work;
+    int i, header = 0;
+
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        thr = &stExpConfig->pThrConfig[i];
+        if (!buf_access(thr) || thr->msgsDone == 0) {
+            continue;
+        }
+        if (!header) {
+            printf("Shared buffer access in ns/msg, %s\n", bufMode == BUF_WC ?
+                   "write-combined" : inBuf_fd >= 0 ? "cached with DMA-BUF sync" :
+                   "cached without sync");
+            printf("%-8s %-10s %8s %9s %9s %9s\n", "Thread", "Direction", "Size",
+                   "Fill", "Sync", "Verify");
+            header = 1;
+        }
+        work = (thr->checkNs + (thr->copy == COPY_BO ? thr->copyNs : 0)) / thr->msgsDone;
+        printf("%-8d %-10s %8d ", thr->thread_num, direction_name(thr), thr->payloadSize);
+        if (thr->config_param == unidirectional_send) {
+            printf("%9lld %9lld %9s\n", work, thr->syncNs / thr->msgsDone, "-");
+        }
+        else {
+            printf("%9s %9lld %9lld\n", "-", thr->syncNs / thr->msgsDone, work);
+        }
+    }
+    if (header) {
+        printf("\n");
+    }
+}
+
+/*
+ *  Achieved message rate and payload bandwidth of every thread over its
+ *  message loop, against the rate asked for by interval. For paced
+ *  senders, how late the sends were against their schedule.
+ */
+static void print_rates(stProPerfConfig *stExpConfig)
+{
+    static const char *paceNames[] = { "sleep", "constant", "poisson", "burst" };
+    thrConfigs *thr;
+    double secs, rate;
+    int i;
+
+    printf("\n%-8s %-12s %-9s %6s %6s %11s %11s %10s %10s %10s %10s\n", "Thread",
+           "Direction", "Pace", "Batch", "Slots", "Asked/s", "Achieved/s", "MB/s",
+           "Lag p50", "Lag p99", "Lag max");
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        thr = &stExpConfig->pThrConfig[i];
+        secs = thr->activeNs / 1000000000.0;
+        rate = secs > 0 ? thr->msgsDone / secs : 0.0;
+
+        printf("%-8d %-12s %-9s %6d %6d %11.1f %11.1f %10.2f", thr->thread_num,
+               direction_name(thr),
+               thr->config_param == unidirectional_send ? paceNames[thr->pace] : "-",
+               thr->batch, thr->slots, thr->numWaitTime ? 1000000.0 / thr->numWaitTime : 0.0, rate,
+               rate * thr->payloadSize / 1000000.0);
+        if (thr->sendLag->count) {
+            printf(" %10.1f %10.1f %10.1f",
+                   hist_percentile(thr->sendLag, 50) / 1000.0,
+                   hist_percentile(thr->sendLag, 99) / 1000.0,
+                   thr->sendLag->max / 1000.0);
+        }
+        printf("\n");
+    }
+}
+
+/*
+ *  Pins the thread to thr->cpu when one was given and, unless withSched
+ *  is 0, sets its policy and priority instead of inheriting ours.
+ */
+static void thread_attr_init(pthread_attr_t *attr, thrConfigs *thr, int withSched)
+{
+    struct sched_param param;
+    cpu_set_t cpus;
+
+    pthread_attr_init(attr);
+    if (thr->cpu >= 0) {
+        CPU_ZERO(&cpus);
+        CPU_SET(thr->cpu, &cpus);
+        pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus);
+    }
+    if (withSched && thr->policy != SCHED_OTHER) {
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = thr->prio;
+        pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(attr, thr->policy);
+        pthread_attr_setschedparam(attr, &param);
+    }
+}
+
+static int thread_create(thrConfigs *thr, void *(*fxn)(void *))
+{
+    pthread_attr_t attr;
+    int ret;
+
+    thread_attr_init(&attr, thr, 1);
+    ret = pthread_create(&thr->thread_id, &attr, fxn, thr);
+    pthread_attr_destroy(&attr);
+
+    if (ret == EPERM) {
+        /* keep the run going, the placement report shows what we got */
+        thr->schedFailed = 1;
+        thread_attr_init(&attr, thr, 0);
+        ret = pthread_create(&thr->thread_id, &attr, fxn, thr);
+        pthread_attr_destroy(&attr);
+    }
+    return ret;
+}
+
+static const char *policy_name(int policy)
+{
+    return policy == SCHED_FIFO ? "fifo" : policy == SCHED_RR ? "rr" : "other";
+}
+
+static void print_placement(stProPerfConfig *stExpConfig)
+{
+    thrConfigs *thr;
+    char asked[32], running[32];
+    int i;
+
+    printf("\n%-8s %-12s %-14s %-14s %-16s %6s %6s %10s\n", "Thread", "Direction",
+           "Asked", "Running", "Allowed CPUs", "First", "Last", "Migrations");
+    for (i = 0; i < stExpConfig->numThreads; i++) {
+        thr = &stExpConfig->pThrConfig[i];
+        if (thr->reactor >= 0) {
+            sprintf(asked, "loop %d", thr->reactor);
+        }
+        else if (thr->cpu >= 0) {
+            sprintf(asked, "%s/%d cpu%d", policy_name(thr->policy), thr->prio, thr->cpu);
+        }
+        else {
+            sprintf(asked, "%s/%d", policy_name(thr->policy), thr->prio);
+        }
+        sprintf(running, "%s/%d", policy_name(thr->runPolicy), thr->runPrio);
+        printf("%-8d %-12s %-14s %-14s %-16s %6d %6d %10d%s\n", thr->thread_num,
+               direction_name(thr), asked, running, thr->allowed,
+               thr->cpuFirst, thr->cpuLast, thr->migrations,
+               thr->schedFailed ? "  (policy not permitted)" : "");
+    }
+}
+
+/*
+ *  Results of the run as JSON, for messageq/host/mq_compare.py. Bump
+ *  RESULTS_VERSION when a field changes meaning. Times are usecs unless
+ *  the name says otherwise.
+ */
+#define RESULTS_VERSION     1
+
+static void json_string(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            fprintf(fp, "\\%c", *str);
+        }
+        else if ((unsigned char)*str < 0x20) {
+            fprintf(fp, "\\u%04x", *str);
+        }
+        else {
+            fputc(*str, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void json_hist(FILE *fp, const char *name, const Hist *h)
+{
+    fprintf(fp, ",\n      \"%s\": ", name);
+    if (h->count == 0) {
+        fprintf(fp, "null");
+        return;
+    }
+    fprintf(fp, "{\"count\": %llu, \"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, "
+            "\"max\": %.3f, \"mean\": %.3f}", (unsigned long long)h->count,
+            hist_percentile(h, 50) / 1000.0, hist_percentile(h, 99) / 1000.0,
+            hist_percentile(h, 99.9) / 1000.0, h->max / 1000.0, hist_mean(h) / 1000.0);
+}
+
+/* The environment and process objects of a results file */
+static void json_run(FILE *fp, long elapsedUs, const struct rusage *ru0,
+                     const struct rusage *ru1)
+{
+    struct utsname uts;
+    char date[32];
+    time_t now = time(NULL);
+
+    if (uname(&uts) < 0) {
+        memset(&uts, 0, sizeof(uts));
+    }
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(fp, "  \"environment\": {\"date\": \"%s\", \"host\": ", date);
+    json_string(fp, uts.nodename);
+    fprintf(fp, ", \"kernel\": ");
+    json_string(fp, uts.release);
+    fprintf(fp, ", \"machine\": ");
+    json_string(fp, uts.machine);
+    fprintf(fp, ", \"cpus\": %ld, \"transport\": \"%s\", \"clock\": \"%s\"},\n",
+            sysconf(_SC_NPROCESSORS_ONLN),
+#ifdef MQ_LOOPBACK
+            "loopback",
+#else
+            "ipc",
+#endif
+            syncCounter ? "32K sync counter" : "CLOCK_MONOTONIC");
+
+    fprintf(fp, "  \"process\": {\"elapsed_ms\": %.3f, \"user_ms\": %.3f, \"sys_ms\": %.3f, "
+            "\"voluntary_cs\": %ld, \"involuntary_cs\": %ld},\n", elapsedUs / 1000.0,
+            tv_ms(&ru1->ru_utime) - tv_ms(&ru0->ru_utime),
+            tv_ms(&ru1->ru_stime) - tv_ms(&ru0->ru_stime),
+            ru1->ru_nvcsw - ru0->ru_nvcsw, ru1->ru_nivcsw - ru0->ru_nivcsw);
+}
+
+static int write_results(const char *path, stProPerfConfig *cfg, const char *cfgPath,
+                         int numLoops, long elapsedUs, const struct rusage *ru0,
+                         const struct rusage *ru1)
+{
+    static const char *paceNames[] = { "sleep", "constant", "poisson", "burst" };
+    thrConfigs *thr;
+    unsigned long long bytes, totalMsgs = 0, totalBytes = 0, totalErrors = 0;
+    double secs, rate;
+    FILE *fp;
+    int i;
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("Couldn't write the results to %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fprintf(fp, "{\n  \"version\": %d,\n  \"config\": {\"file\": ", RESULTS_VERSION);
+    json_string(fp, cfgPath);
+    fprintf(fp, ", \"streams\": %d, \"mode\": \"%s\", \"loops\": %d, \"buffer\": \"%s\"},\n",
+            cfg->numThreads, numLoops ? "reactor" : "threads", numLoops,
+            buf_mode_name());
+
+    json_run(fp, elapsedUs, ru0, ru1);
+    fprintf(fp, "  \"startup\": {\"ipc_ms\": %.3f, \"rpc_ms\": %.3f, \"ready_ms\": %.3f, "
+            "\"opens\": %u, \"handshake_ms\": %.3f, \"launch_ms\": %.3f, "
+            "\"first_msg_ms\": %.3f},\n", bringup_ms(bringup.ipc), bringup_ms(bringup.rpc),
+            bringup_ms(bringup.ready), bringup.opens, bringup_ms(bringup.handshake),
+            bringup_ms(bringup.launch), bringup_ms(first_msg_of(cfg)));
+    fprintf(fp, "  \"threads\": [");
+    for (i = 0; i < cfg->numThreads; i++) {
+        thr = &cfg->pThrConfig[i];
+        secs = thr->activeNs / 1000000000.0;
+        rate = secs > 0 ? thr->msgsDone / secs : 0.0;
+        bytes = (unsigned long long)thr->msgsDone * thr->payloadSize;
+        totalMsgs += thr->msgsDone;
+        totalBytes += bytes;
+        totalErrors += thr->idErrors + thr->slotErrors + thr->crcErrors;
+
+        fprintf(fp, "%s\n    {\"thread\": %d, \"direction\": \"%s\",\n", i ? "," : "",
+                thr->thread_num, direction_name(thr));
+        fprintf(fp, "      \"config\": {\"direction\": %d, \"msgSize\": %d, \"msgCount\": %d, "
+                "\"interval\": %d, \"pace\": \"%s\", \"burst\": %d, \"batch\": %d, "
+                "\"pool\": %d, \"slots\": %d, \"check\": %d, \"outstanding\": %d, "
+                "\"cpu\": %d, \"policy\": \"%s\", \"prio\": %d, \"loop\": %d, "
+                "\"copy\": %d, \"memcpy\": \"%s\"},\n",
+                thr->config_param, thr->payloadSize, thr->numMessages, thr->numWaitTime,
+                paceNames[thr->pace], thr->burst, thr->batch,
+                thr->slots ? 0 : thr->poolSize, thr->slots, thr->check,
+                thr->config_param == bidirectional ? thr->outstanding : 0,
+                thr->cpu, policy_name(thr->policy), thr->prio, thr->reactor,
+                thr->copy, copy_kernel_name(thr->copyKernel));
+        fprintf(fp, "      \"messages\": %u, \"bytes\": %llu, \"seconds\": %.6f, "
+                "\"rate_asked\": %.3f, \"rate\": %.3f, \"mbps\": %.3f, \"cpu_ms\": %.3f, "
+                "\"copy_ms\": %.3f, \"check_ms\": %.3f, \"sync_ms\": %.3f,\n"
+                "      \"open_ms\": %.3f, \"opens\": %u, \"first_msg_ms\": %.3f,\n",
+                thr->msgsDone, bytes, secs,
+                thr->numWaitTime ? 1000000.0 / thr->numWaitTime : 0.0, rate,
+                rate * thr->payloadSize / 1000000.0, thr->cpuNs / 1000000.0,
+                thr->copyNs / 1000000.0, thr->checkNs / 1000000.0, thr->syncNs / 1000000.0,
+                thr->openNs / 1000000.0, thr->opens,
+                thr->firstNs ? (thr->firstNs - bringup.launch) / 1000000.0 : 0.0);
+        fprintf(fp, "      \"errors\": {\"id\": %u, \"slot\": %u, \"crc\": %u}, "
+                "\"pool\": {\"exhausted\": %u, \"wait_us\": %ld, \"low_water\": %u}",
+                thr->idErrors, thr->slotErrors, thr->crcErrors,
+                thr->poolExhausted, thr->poolWaitUs, thr->poolLowWater);
+        json_hist(fp, "latency_us", thr->latency);
+        json_hist(fp, "rtt_us", thr->rtt);
+        json_hist(fp, "send_lag_us", thr->sendLag);
+        fprintf(fp, "}");
+    }
+    fprintf(fp, "\n  ],\n  \"totals\": {\"messages\": %llu, \"bytes\": %llu, \"errors\": %llu}\n}\n",
+            totalMsgs, totalBytes, totalErrors);
+
+    if (fclose(fp) != 0) {
+        printf("Couldn't write the results to %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    printf("Results written to %s\n", path);
+    return 0;
+}
+
+/*
+ *  Turns line c of the cfg into stream i of cfg, exits on a value the
+ *  stream can't run with. c gets the defaults the stream ends up with.
+ */
+static void config_stream(stProPerfConfig *cfg, int i, struct config *c, int numLoops,
+                          int verbose)
+{
+    thrConfigs *thr = &cfg->pThrConfig[i];
+
+    thr->thread_num = i;
+    thr->numMessages = c->msgCount;
+    thr->numWaitTime = c->interval;
+    thr->payloadSize = c->msgSize;
+    thr->procId = c->procID;
+    thr->config_param = c->direction;
+    thr->poolSize = c->pool;
+    thr->recvMode = c->recv;
+    thr->spinUs = c->spin ? c->spin : DEFAULT_SPIN_US;
+    thr->cpu = c->cpu;
+    thr->pace = c->pace;
+    thr->burst = c->burst;
+    thr->policy = c->policy == 1 ? SCHED_FIFO :
+                  c->policy == 2 ? SCHED_RR : SCHED_OTHER;
+    thr->prio = c->prio;
+    thr->batch = c->batch > 0 ? c->batch : 1;
+    if (c->check && c->direction != bidirectional) {
+        thr->check = 1;
+        if (!c->slots) {
+            c->slots = DEFAULT_CHECK_SLOTS;
+        }
+    }
+    thr->slots = c->slots;
+    thr->outstanding = c->outstanding > 0 ? c->outstanding : 1;
+    thr->reactor = (numLoops && c->direction != bidirectional) ? 0 : -1;
+    if (c->direction < unidirectional_send || c->direction > bidirectional) {
+        printf("Thread [%d] : invalid direction=%d\n", i, c->direction);
+        exit(1);
+    }
+    if (c->copy && (c->direction == bidirectional || c->slots || c->check)) {
+        /* the copy paths compare plain one-way streams */
+        printf("Thread [%d] : copy only runs on one-way streams without slots and check\n", i);
+        exit(1);
+    }
+    if (c->copy < COPY_NONE || c->copy > COPY_BO || copy_kernel(c->copyKernel) == NULL) {
+        printf("Thread [%d] : invalid copy=%d memcpy=%d\n", i, c->copy, c->copyKernel);
+        exit(1);
+    }
+    if (c->copy == COPY_INLINE && c->msgSize > COPY_INLINE_MAX) {
+        printf("Thread [%d] : copy=1 carries at most %d bytes in a message, msgSize=%d\n", i,
+               (int)COPY_INLINE_MAX, c->msgSize);
+        exit(1);
+    }
+    thr->copy = c->copy;
+    thr->copyKernel = c->copyKernel;
+    thr->copyFxn = copy_kernel(c->copyKernel);
+    if (thr->copy) {
+        thr->copyBuf = malloc(thr->payloadSize ? thr->payloadSize : 1);
+        if (thr->copyBuf == NULL) {
+            printf("Thread [%d] : no memory for the copy buffer\n", i);
+            exit(1);
+        }
+        memset(thr->copyBuf, thr->thread_num, thr->payloadSize);
+    }
+    if (c->direction == bidirectional && (c->slots || c->pool || c->check)) {
+        /* the echo loop owns its messages */
+        printf("Thread [%d] : pool, slots and check not used with direction=2\n", i);
+        thr->slots = 0;
+        thr->poolSize = 0;
+        c->slots = 0;
+    }
+    if (c->slots) {
+        /* one credit per slot */
+        thr->poolSize = c->slots;
+        if (c->msgSize < 2 * sizeof(uint32_t) || c->msgSize % sizeof(uint32_t)) {
+            printf("Thread [%d] : slots need a msgSize of 8 bytes or more, 4 bytes aligned\n", i);
+            exit(1);
+        }
+    }
+    thr->latency = malloc(sizeof(Hist));
+    hist_init(thr->latency);
+    thr->sendLag = malloc(sizeof(Hist));
+    hist_init(thr->sendLag);
+    thr->rtt = malloc(sizeof(Hist));
+    hist_init(thr->rtt);
+
+    if (c->pace < PACE_SLEEP || c->pace > PACE_BURST) {
+        printf("Thread [%d] : invalid pace=%d\n", i, c->pace);
+        exit(1);
+    }
+    if (c->policy < 0 || c->policy > 2 ||
+        (c->policy && (c->prio < sched_get_priority_min(SCHED_FIFO) ||
+                       c->prio > sched_get_priority_max(SCHED_FIFO)))) {
+        printf("Thread [%d] : invalid policy=%d prio=%d\n", i,
+               c->policy, c->prio);
+        exit(1);
+    }
+    if (c->recv < RECV_BLOCK || c->recv > RECV_SPIN) {
+        printf("Thread [%d] : invalid recv=%d\n", i, c->recv);
+        exit(1);
+    }
+    if (c->procID != cfg->procId) {
+        printf("Thread [%d] : procID=%d, only core %d is set up\n", i,
+               c->procID, cfg->procId);
+        exit(1);
+    }
+    if (c->cpu >= sysconf(_SC_NPROCESSORS_CONF)) {
+        printf("Thread [%d] : cpu=%d not present, not pinned\n", i, c->cpu);
+        thr->cpu = -1;
+    }
+
+    if (!verbose) {
+        return;
+    }
+    printf("Thread [%d] : direction = %d, msgSize = %d, msgCount = %d, interval = %d, procID = %d, pool = %d, recv = %d, cpu = %d, pace = %d, policy = %d, prio = %d, batch = %d, slots = %d, outstanding = %d, check = %d, copy = %d, memcpy = %d\n",
+           thr->thread_num,
+           thr->config_param,
+           thr->payloadSize,
+           thr->numMessages,
+           thr->numWaitTime,
+           thr->procId,
+           thr->poolSize,
+           thr->recvMode,
+           thr->cpu,
+           thr->pace,
+           c->policy,
+           thr->prio,
+           thr->batch,
+           thr->slots,
+           thr->outstanding,
+           thr->check,
+           thr->copy,
+           thr->copyKernel);
+}
+
+/* Lays the streams out after the stream table, returns the bytes used */
+static unsigned int streams_layout(stProPerfConfig *cfg)
+{
+    unsigned int offset = stream_table_bytes(cfg->numThreads);
+    int i;
+
+    for (i = 0; i < cfg->numThreads; i++) {
+        thrConfigs *thr = &cfg->pThrConfig[i];
+
+        thr->bufOffset = offset;
+        offset += stream_bytes(thr);
+        if (cfg->bufferPtr == NULL) {
+            continue;
+        }
+        thr->boBufPayloadPtr = cfg->bufferPtrRemoteAddr + thr->bufOffset;
+        thr->boBufPayloadSize = thr->payloadSize;
+        thr->bufCpuPtr = cfg->bufferPtr + thr->bufOffset / sizeof(uint32_t);
+    }
+    return offset;
+}
+
+static void streams_free(stProPerfConfig *cfg)
+{
+    int i;
+
+    for (i = 0; cfg->pThrConfig && i < cfg->numThreads; i++) {
+        free(cfg->pThrConfig[i].latency);
+        free(cfg->pThrConfig[i].sendLag);
+        free(cfg->pThrConfig[i].rtt);
+        free(cfg->pThrConfig[i].copyBuf);
+    }
+    free(cfg->pThrConfig);
+    cfg->pThrConfig = NULL;
+}
+
+/*
+ *  One session with the remote: hands it the stream table, runs the
+ *  streams to the end and returns the wall time and rusage around them.
+ *  The session is over once dataTransactFxn() has run.
+ */
+static Int run_streams(stProPerfConfig *cfg, int numLoops, Reactor **loopsOut,
+                       long *elapsed, struct rusage *ruStart, struct rusage *ruEnd)
+{
+    struct timespec start, end;
+    Reactor *loops = NULL;
+    int i, ret;
+
+    *loopsOut = NULL;
+
+    /* handshake with remote to pass it the stream table */
+    MessageQApp_handshake(*cfg);
+
+    getrusage(RUSAGE_SELF, ruStart);
+    clock_gettime(CLOCK_REALTIME, &start);
+    bringup.launch = nsecs();
+
+    if (numLoops) {
+        *loopsOut = loops = reactor_start(cfg, numLoops);
+        if (loops == NULL) {
+            printf("MessageQMulti: no memory for %d loops\n", numLoops);
+            return -1;
+        }
+    }
+
+    /* Launch multiple threads: */
+    for (i = 0; i < cfg->numThreads; i++) {
+        if (cfg->pThrConfig[i].reactor >= 0) {
+            continue;
+        }
+
+        /* Create the test threads as per directions: */
+	if(cfg->pThrConfig[i].config_param == unidirectional_send)
+	{
+		ret = thread_create(&cfg->pThrConfig[i], &pingThreadFxn_uni_send);
+		if (ret) {
+			printf("MessageQMulti: can't spawn thread: %d, %s\n",
+						i, strerror(ret));
+		}
+#if PRINT_DEBUG
+		printf("Sender Thread:%d Direction:%d bufferPtr = %p, bufferPtrRemoteAddr = 0x%x bufferPtrSize = %d\n", 
+			 cfg->pThrConfig[i].thread_num, 
+			 cfg->pThrConfig[i].config_param,
+			 cfg->bufferPtr,
+			 cfg->pThrConfig[i].boBufPayloadPtr,
+			 cfg->pThrConfig[i].boBufPayloadSize);
+#endif
+	}
+	else if(cfg->pThrConfig[i].config_param == unidirectional_recv)
+	{
+			ret = thread_create(&cfg->pThrConfig[i], &pingThreadFxn_uni_recv);
+			if (ret) {
+				printf("MessageQMulti: can't spawn thread: %d, %s\n",
+						i, strerror(ret));
+			}
+#if PRINT_DEBUG
+                printf("Receiver Thread:%d Direction:%d bufferPtr = %p, bufferPtrRemoteAddr = 0x%x bufferPtrSize = %d\n",
+                         cfg->pThrConfig[i].thread_num,
+                         cfg->pThrConfig[i].config_param,
+                         cfg->bufferPtr,
+                         cfg->pThrConfig[i].boBufPayloadPtr,
+                         cfg->pThrConfig[i].boBufPayloadSize);
+
+#endif
+	}
+	else if(cfg->pThrConfig[i].config_param == bidirectional)
+	{
+		ret = thread_create(&cfg->pThrConfig[i], &pingThreadFxn_bidir);
+		if (ret) {
+			printf("MessageQMulti: can't spawn thread: %d, %s\n",
+						i, strerror(ret));
+		}
+	}
+    }
+
+    /* Join all threads: */
+    for (i = 0; i < cfg->numThreads; i++) {
+        if (cfg->pThrConfig[i].reactor >= 0) {
+            continue;
+        }
+        ret = pthread_join(cfg->pThrConfig[i].thread_id, NULL);
+        if (ret != 0) {
+            printf("MessageQMulti: failed to join thread: %d, %s\n",
+                    i, strerror(ret));
+        }
+#if PRINT_DEBUG
+        printf("MessageQMulti: Joined with thread %d\n",cfg->pThrConfig[i].thread_num);
+#endif
+    }
+    for (i = 0; i < numLoops; i++) {
+        if (loops[i].thread_id == 0) {
+            continue;
+        }
+        ret = pthread_join(loops[i].thread_id, NULL);
+        if (ret != 0) {
+            printf("MessageQMulti: failed to join reactor: %d, %s\n",
+                    i, strerror(ret));
+        }
+    }
+    
+    clock_gettime(CLOCK_REALTIME, &end);
+    getrusage(RUSAGE_SELF, ruEnd);
+    *elapsed = diff(start, end);
+
+    return 0;
+}
+
+/*
+ *  Sweep (-s)
+ *
+ *  -s "msgSize=64:4096:x4,threads=1:8:x2,interval=100|500" runs the cfg at
+ *  every combination of the values, the last key changing fastest. A range
+ *  is first:last[:step], where step xN multiplies, +N or N adds, and x2 is
+ *  used when it is left out; a|b|c lists the values. Any cfg key can be
+ *  swept and is set on every line of the cfg, plus threads (copies of the
+ *  cfg lines) and loops (-r, 0 = a thread per stream).
+ *
+ *  All points share one Ipc_start(), MmRpc connection and shared buffer,
+ *  sized for the largest point. A point is two sessions with the remote: a
+ *  warm-up of -w messages per stream (10% of msgCount by default) that is
+ *  thrown away, then the measured run.
+ */
+#define SWEEP_MAX_AXES      8
+#define SWEEP_MAX_VALUES    64
+
+typedef struct SweepAxis {
+    char key[16];
+    int numValues;
+    int value[SWEEP_MAX_VALUES];
+} SweepAxis;
+
+typedef struct SweepPoint {
+    int value[SWEEP_MAX_AXES];
+    int streams;
+    int loops;
+    unsigned long long expected; /* Messages asked for */
+    unsigned long long msgs;
+    unsigned long long bytes;
+    unsigned long long errors;
+    long elapsedUs;
+    double rate; /* Sum of the streams' msgs/s over their message loops */
+    double mbps;
+    double cpuMs;
+    Hist latency;
+    Hist rtt;
+    Hist sendLag;
+} SweepPoint;
+
+typedef struct Sweep {
+    char spec[256];
+    int numAxes;
+    SweepAxis axis[SWEEP_MAX_AXES];
+    int numPoints;
+    int numDone;
+    SweepPoint *point;
+    int warmup; /* Messages per stream, -1 = 10% of msgCount, 0 = none */
+} Sweep;
+
+static int sweep_range(SweepAxis *ax, char *range)
+{
+    char *end, *item, *save;
+    long first, last, step = 2, v;
+    int geometric = 1;
+
+    if (strchr(range, ':') == NULL) {
+        for (item = strtok_r(range, "|", &save); item; item = strtok_r(NULL, "|", &save)) {
+            v = strtol(item, &end, 0);
+            if (*end || end == item || ax->numValues == SWEEP_MAX_VALUES) {
+                return -1;
+            }
+            ax->value[ax->numValues++] = v;
+        }
+        return ax->numValues ? 0 : -1;
+    }
+
+    first = strtol(range, &end, 0);
+    if (*end != ':') {
+        return -1;
+    }
+    last = strtol(end + 1, &end, 0);
+    if (*end == ':') {
+        end++;
+        geometric = (*end == 'x');
+        if (*end == 'x' || *end == '+') {
+            end++;
+        }
+        step = strtol(end, &end, 0);
+    }
+    if (*end || first < 0 || last < first || step < (geometric ? 2 : 1) ||
+        (geometric && first == 0)) {
+        return -1;
+    }
+    for (v = first; v <= last; v = geometric ? v * step : v + step) {
+        if (ax->numValues == SWEEP_MAX_VALUES) {
+            return -1;
+        }
+        ax->value[ax->numValues++] = v;
+    }
+    return 0;
+}
+
+/* 0 if key can be swept to value, -1 for an unknown key, 1 for a bad value */
+typedef int (*SweepKeyFxn)(const char *key, int value);
+
+static int sweep_key(const char *key, int value)
+{
+    if (strcmp(key, "threads") == 0) {
+        return value < 1;
+    }
+    if (strcmp(key, "loops") == 0) {
+        return value < 0;
+    }
+    return validatekey((char *)key) ? -1 : 0;
+}
+
+static int sweep_parse(Sweep *sw, const char *spec, SweepKeyFxn check)
+{
+    char buf[256], *item, *save, *eq;
+    SweepAxis *ax;
+    int k, n;
+
+    if (strlen(spec) >= sizeof(buf)) {
+        printf("Sweep: spec longer than %d characters\n", (int)sizeof(buf) - 1);
+        return -1;
+    }
+    strcpy(sw->spec, spec);
+    strcpy(buf, spec);
+    sw->numPoints = 1;
+
+    for (item = strtok_r(buf, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        eq = strchr(item, '=');
+        if (eq == NULL || eq == item || eq - item >= sizeof(ax->key)) {
+            printf("Sweep: expected key=range, got \"%s\"\n", item);
+            return -1;
+        }
+        *eq = '\0';
+        if (check(item, 0) < 0) {
+            printf("Sweep: unknown key %s\n", item);
+            return -1;
+        }
+        for (k = 0; k < sw->numAxes; k++) {
+            if (strcmp(sw->axis[k].key, item) == 0) {
+                printf("Sweep: %s given twice\n", item);
+                return -1;
+            }
+        }
+        if (sw->numAxes == SWEEP_MAX_AXES) {
+            printf("Sweep: more than %d keys\n", SWEEP_MAX_AXES);
+            return -1;
+        }
+        ax = &sw->axis[sw->numAxes++];
+        strcpy(ax->key, item);
+        if (sweep_range(ax, eq + 1) < 0) {
+            printf("Sweep: bad range for %s, first:last[:xN|+N] or a|b|c, at most %d values\n",
+                   item, SWEEP_MAX_VALUES);
+            return -1;
+        }
+        for (n = 0; n < ax->numValues; n++) {
+            if (check(item, ax->value[n])) {
+                printf("Sweep: %s=%d\n", item, ax->value[n]);
+                return -1;
+            }
+        }
+        sw->numPoints *= ax->numValues;
+    }
+    if (sw->numAxes == 0) {
+        printf("Sweep: nothing to sweep\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Values of point p, the last axis changing fastest */
+static void sweep_values(const Sweep *sw, int p, int *value)
+{
+    int k;
+
+    for (k = sw->numAxes - 1; k >= 0; k--) {
+        value[k] = sw->axis[k].value[p % sw->axis[k].numValues];
+        p /= sw->axis[k].numValues;
+    }
+}
+
+/*
+ *  Streams of the point with these values, laid out in cfg's buffer.
+ *  warmup as in Sweep, 0 for the measured run. Returns the bytes used.
+ */
+static unsigned int sweep_streams(const Sweep *sw, const int *value, stProPerfConfig *cfg,
+                                  int warmup, int *numLoops)
+{
+    struct config c;
+    int copies = 1, i, k;
+
+    for (k = 0; k < sw->numAxes; k++) {
+        if (strcmp(sw->axis[k].key, "threads") == 0) {
+            copies = value[k];
+        }
+        else if (strcmp(sw->axis[k].key, "loops") == 0) {
+            *numLoops = value[k];
+        }
+    }
+
+    cfg->numThreads = linecount * copies;
+    cfg->pThrConfig = (thrConfigs *)calloc(cfg->numThreads, sizeof(thrConfigs));
+    if (cfg->pThrConfig == NULL) {
+        printf("Sweep: no memory for %d streams\n", cfg->numThreads);
+        exit(1);
+    }
+    for (i = 0; i < cfg->numThreads; i++) {
+        c = xyz[i % linecount];
+        for (k = 0; k < sw->numAxes; k++) {
+            config_set(&c, sw->axis[k].key, value[k]);
+        }
+        if (warmup > 0) {
+            c.msgCount = warmup;
+        }
+        else if (warmup < 0) {
+            c.msgCount = c.msgCount / 10 ? c.msgCount / 10 : 1;
+        }
+        config_stream(cfg, i, &c, *numLoops, 0);
+    }
+    return streams_layout(cfg);
+}
+
+/* Checks every point and returns the shared buffer the largest one needs */
+static unsigned int sweep_size(const Sweep *sw, stProPerfConfig *cfg, int numLoops)
+{
+    int value[SWEEP_MAX_AXES];
+    unsigned int size, max = 0;
+    int p, loops;
+
+    for (p = 0; p < sw->numPoints; p++) {
+        loops = numLoops;
+        sweep_values(sw, p, value);
+        size = sweep_streams(sw, value, cfg, 0, &loops);
+        if (size > max) {
+            max = size;
+        }
+        streams_free(cfg);
+    }
+    return max;
+}
+
+static void sweep_collect(SweepPoint *pt, stProPerfConfig *cfg, long elapsed,
+                          const struct rusage *ru0, const struct rusage *ru1)
+{
+    thrConfigs *thr;
+    double rate;
+    int i;
+
+    hist_init(&pt->latency);
+    hist_init(&pt->rtt);
+    hist_init(&pt->sendLag);
+    for (i = 0; i < cfg->numThreads; i++) {
+        thr = &cfg->pThrConfig[i];
+        pt->expected += thr->numMessages;
+        pt->msgs += thr->msgsDone;
+        pt->bytes += (unsigned long long)thr->msgsDone * thr->payloadSize;
+        pt->errors += thr->idErrors + thr->slotErrors + thr->crcErrors;
+        rate = thr->activeNs ? thr->msgsDone * 1000000000.0 / thr->activeNs : 0.0;
+        pt->rate += rate;
+        pt->mbps += rate * thr->payloadSize / 1000000.0;
+        hist_merge(&pt->latency, thr->latency);
+        hist_merge(&pt->rtt, thr->rtt);
+        hist_merge(&pt->sendLag, thr->sendLag);
+    }
+    pt->streams = cfg->numThreads;
+    pt->elapsedUs = elapsed;
+    pt->cpuMs = tv_ms(&ru1->ru_utime) - tv_ms(&ru0->ru_utime) +
+                tv_ms(&ru1->ru_stime) - tv_ms(&ru0->ru_stime);
+}
+
+static void sweep_label(const Sweep *sw, const SweepPoint *pt)
+{
+    int k;
+
+    for (k = 0; k < sw->numAxes; k++) {
+        printf("%s%s=%d", k ? " " : "", sw->axis[k].key, pt->value[k]);
+    }
+}
+
+/* One session of the point's streams, the remote is done with it on return */
+static Int sweep_session(const Sweep *sw, SweepPoint *pt, stProPerfConfig *cfg,
+                         int numLoops, int warmup)
+{
+    Reactor *loops = NULL;
+    struct rusage ru0, ru1;
+    long elapsed;
+    Int status;
+
+    sweep_streams(sw, pt->value, cfg, warmup, &numLoops);
+    pt->loops = numLoops;
+    status = run_streams(cfg, numLoops, &loops, &elapsed, &ru0, &ru1);
+    if (status >= 0) {
+        if (!warmup) {
+            sweep_collect(pt, cfg, elapsed, &ru0, &ru1);
+        }
+        dataTransactFxn(*cfg);
+    }
+    reactor_free(loops, numLoops);
+    streams_free(cfg);
+    return status;
+}
+
+static void print_hist_us(const Hist *h, double pct)
+{
+    if (h->count) {
+        printf(" %9.1f", hist_percentile(h, pct) / 1000.0);
+    }
+    else {
+        printf(" %9s", "-");
+    }
+}
+
+static void print_surface(const Sweep *sw)
+{
+    const SweepPoint *pt;
+    int k, p;
+
+    printf("\nSurface: %d of %d points, ", sw->numDone, sw->numPoints);
+    if (sw->warmup > 0) {
+        printf("warm-up %d msgs/stream\n", sw->warmup);
+    }
+    else {
+        printf("%s\n", sw->warmup ? "warm-up 10% of msgCount" : "no warm-up");
+    }
+    for (k = 0; k < sw->numAxes; k++) {
+        printf("%11.11s ", sw->axis[k].key);
+    }
+    printf("%7s %11s %9s %9s %9s %9s %9s %9s %8s %8s %6s\n", "Streams", "Msgs/s", "MB/s",
+           "Lat p50", "Lat p99", "RTT p50", "RTT p99", "Lag p99", "CPU/msg", "Lost", "Errors");
+    for (p = 0; p < sw->numDone; p++) {
+        pt = &sw->point[p];
+        for (k = 0; k < sw->numAxes; k++) {
+            printf("%11d ", pt->value[k]);
+        }
+        printf("%7d %11.1f %9.2f", pt->streams, pt->rate, pt->mbps);
+        print_hist_us(&pt->latency, 50);
+        print_hist_us(&pt->latency, 99);
+        print_hist_us(&pt->rtt, 50);
+        print_hist_us(&pt->rtt, 99);
+        print_hist_us(&pt->sendLag, 99);
+        printf(" %8.2f %8llu %6llu\n", pt->msgs ? pt->cpuMs * 1000.0 / pt->msgs : 0.0,
+               pt->expected - pt->msgs, pt->errors);
+    }
+    printf("Latencies and CPU (user+sys of the process) in us; "
+           "Lost is messages asked for and not moved.\n");
+}
+
+static int sweep_axis(const Sweep *sw, const char *key)
+{
+    int k;
+
+    for (k = 0; k < sw->numAxes; k++) {
+        if (strcmp(sw->axis[k].key, key) == 0) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/* Index of the point with these values, -1 if a value is not swept */
+static int sweep_index(const Sweep *sw, const int *value)
+{
+    int k, n, p = 0;
+
+    for (k = 0; k < sw->numAxes; k++) {
+        for (n = 0; n < sw->axis[k].numValues; n++) {
+            if (sw->axis[k].value[n] == value[k]) {
+                break;
+            }
+        }
+        if (n == sw->axis[k].numValues) {
+            return -1;
+        }
+        p = p * sw->axis[k].numValues + n;
+    }
+    return p;
+}
 
-    for (i = 0; i < (stExpConfig.bufferPtrSize/sizeof(uint32_t)); i++) {
-        ((unsigned int *)stExpConfig.bufferPtr)[i] = 0xbeefdead;
+/*
+ *  With copy and msgSize in the sweep: for every copy path and every
+ *  combination of the other keys, the msgSize from which the zero copy
+ *  path moves more messages per second than the copy path, at that and
+ *  every larger size. msgSize has to go up. Rates only differ where the
+ *  senders are not paced, so the cfg wants interval=0 for this.
+ */
+static void print_crossover(const Sweep *sw)
+{
+    const SweepAxis *sizes;
+    const SweepPoint *pt, *zero, *copy;
+    int value[SWEEP_MAX_AXES];
+    int kc = sweep_axis(sw, "copy"), ks = sweep_axis(sw, "msgSize");
+    int k, n, p, qz, qc, from, compared, header = 0;
+
+    if (kc < 0 || ks < 0) {
+        return;
     }
+    sizes = &sw->axis[ks];
 
-    /* Have the rem te proc reply to this message queue */
-    MessageQ_setReplyQueue (handle, msg1);
-    ((RemoteBufSyncMsg *)msg1)->boBufPayloadPtr = stExpConfig.bufferPtrRemoteAddr;
-    ((RemoteBufSyncMsg *)msg1)->boBufPayloadSize = stExpConfig.bufferPtrSize;
+    for (p = 0; p < sw->numDone; p++) {
+        pt = &sw->point[p];
+        /* one line per copy path and combination of the other keys */
+        if (pt->value[ks] != sizes->value[0] || pt->value[kc] == COPY_NONE) {
+            continue;
+        }
+        memcpy(value, pt->value, sizeof(value));
+        from = -1;
+        compared = 0;
+        for (n = sizes->numValues - 1; n >= 0; n--) {
+            value[ks] = sizes->value[n];
+            value[kc] = COPY_NONE;
+            qz = sweep_index(sw, value);
+            value[kc] = pt->value[kc];
+            qc = sweep_index(sw, value);
+            if (qz < 0 || qz >= sw->numDone || qc >= sw->numDone) {
+                continue;
+            }
+            zero = &sw->point[qz];
+            copy = &sw->point[qc];
+            compared++;
+            if (zero->rate < copy->rate) {
+                break;
+            }
+            from = sizes->value[n];
+        }
+        if (compared == 0) {
+            continue;
+        }
 
-    status = MessageQ_put (queueId, msg1);
-    if (status < 0) {
-        printf ("Error in MessageQ_put [0x%x]\n", status);
-        goto cleanup;
+        if (!header++) {
+            printf("\nCrossover, msgs/s of zero copy against the copy paths:\n");
+        }
+        printf(" ");
+        for (k = 0; k < sw->numAxes; k++) {
+            if (k != ks) {
+                printf(" %s=%d", sw->axis[k].key, pt->value[k]);
+            }
+        }
+        if (from < 0) {
+            printf(": copying is ahead at msgSize=%d\n", sizes->value[sizes->numValues - 1]);
+        }
+        else if (from == sizes->value[0]) {
+            printf(": zero copy is ahead at every msgSize\n");
+        }
+        else {
+            printf(": zero copy is ahead from msgSize=%d\n", from);
+        }
     }
+}
 
-    status = MessageQ_get(handle, &msg1, MessageQ_FOREVER);
-    if (status < 0) {
-       printf ("Error in MessageQ_get [0x%x]\n", status);
-       goto cleanup;
+/* The points as the threads of a results file, see write_results() */
+static int write_surface(const char *path, const Sweep *sw, const char *cfgPath,
+                         const char *mode, int numLoops, long elapsedUs,
+                         const struct rusage *ru0, const struct rusage *ru1)
+{
+    const SweepPoint *pt;
+    unsigned long long totalMsgs = 0, totalBytes = 0, totalErrors = 0;
+    FILE *fp;
+    int k, p;
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("Couldn't write the results to %s: %s\n", path, strerror(errno));
+        return -1;
     }
-    else {
-       for (i = 0; i < (stExpConfig.bufferPtrSize/sizeof(uint32_t)); i++) {
-              if (((unsigned int *)stExpConfig.bufferPtr)[i] != 0xdeadbeef) {
-              status = 1;
-              printf ("Data integrity failure!\n"
-                "    Expected %s\n"
-                "    Received 0x%x\n",
-                "0xdeadbeef", ((unsigned int *)stExpConfig.bufferPtr)[i]);
-              break;
+    fprintf(fp, "{\n  \"version\": %d,\n  \"config\": {\"file\": ", RESULTS_VERSION);
+    json_string(fp, cfgPath);
+    fprintf(fp, ", \"streams\": %d, \"mode\": \"%s\", \"loops\": %d, \"sweep\": ",
+            linecount, mode, numLoops);
+    json_string(fp, sw->spec);
+    fprintf(fp, ", \"warmup\": %d, \"buffer\": \"%s\"},\n", sw->warmup,
+            buf_mode_name());
+
+    json_run(fp, elapsedUs, ru0, ru1);
+    fprintf(fp, "  \"points\": [");
+    for (p = 0; p < sw->numDone; p++) {
+        pt = &sw->point[p];
+        totalMsgs += pt->msgs;
+        totalBytes += pt->bytes;
+        totalErrors += pt->errors;
+
+        fprintf(fp, "%s\n    {\"point\": %d, \"direction\": \"sweep\",\n      \"config\": {",
+                p ? "," : "", p);
+        for (k = 0; k < sw->numAxes; k++) {
+            fprintf(fp, "%s\"%s\": %d", k ? ", " : "", sw->axis[k].key, pt->value[k]);
         }
+        fprintf(fp, "},\n      \"streams\": %d, \"loops\": %d, \"messages\": %llu, "
+                "\"expected\": %llu, \"bytes\": %llu, \"seconds\": %.6f, \"rate\": %.3f, "
+                "\"mbps\": %.3f, \"cpu_ms\": %.3f,\n      \"errors\": {\"total\": %llu}",
+                pt->streams, pt->loops, pt->msgs, pt->expected, pt->bytes,
+                pt->elapsedUs / 1000000.0, pt->rate, pt->mbps, pt->cpuMs,
+                pt->errors);
+        json_hist(fp, "latency_us", &pt->latency);
+        json_hist(fp, "rtt_us", &pt->rtt);
+        json_hist(fp, "send_lag_us", &pt->sendLag);
+        fprintf(fp, "}");
     }
-    if(status != 1)
-        printf("%s:Test Pass\n",__func__);
-    /* Validate the returned message. */
-    status = MessageQ_free (msg1);
-   }
+    fprintf(fp, "\n  ],\n  \"totals\": {\"messages\": %llu, \"bytes\": %llu, \"errors\": %llu}\n}\n",
+            totalMsgs, totalBytes, totalErrors);
 
-    MessageQ_close (&queueId);
+    if (fclose(fp) != 0) {
+        printf("Couldn't write the results to %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    printf("Results written to %s\n", path);
+    return 0;
+}
 
-cleanup:
-    /* Clean-up */
-    status = MessageQ_delete (&handle);
-    if (status < 0) {
-        printf ("Error in MessageQ_delete [0x%x]\n", status);
+/* Runs every point of sw in the IPC session and shared buffer of cfg */
+static Int run_sweep(Sweep *sw, stProPerfConfig *cfg, int numLoops, const char *cfgPath,
+                     const char *resultsPath)
+{
+    struct timespec start, end;
+    struct rusage ru0, ru1;
+    SweepPoint *pt;
+    Int status = 0;
+    int p;
+
+    sw->point = calloc(sw->numPoints, sizeof(SweepPoint));
+    if (sw->point == NULL) {
+        printf("Sweep: no memory for %d points\n", sw->numPoints);
+        return -1;
     }
 
-exit:
+    getrusage(RUSAGE_SELF, &ru0);
+    clock_gettime(CLOCK_REALTIME, &start);
+    for (p = 0; p < sw->numPoints && status >= 0; p++) {
+        pt = &sw->point[p];
+        sweep_values(sw, p, pt->value);
+        printf("\nPoint %d/%d: ", p + 1, sw->numPoints);
+        sweep_label(sw, pt);
+        printf("\n");
+
+        if (sw->warmup) {
+            status = sweep_session(sw, pt, cfg, numLoops, sw->warmup);
+            if (status < 0) {
+                break;
+            }
+        }
+        status = sweep_session(sw, pt, cfg, numLoops, 0);
+        if (status < 0) {
+            break;
+        }
+        sw->numDone++;
+        printf("Point %d/%d: %.1f msgs/s, %.2f MB/s, %llu lost, %llu errors\n", p + 1,
+               sw->numPoints, pt->rate, pt->mbps, pt->expected - pt->msgs,
+               pt->errors);
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+    getrusage(RUSAGE_SELF, &ru1);
+
+    print_surface(sw);
+    print_crossover(sw);
+    write_surface(resultsPath, sw, cfgPath, numLoops ? "reactor" : "threads", numLoops,
+                  diff(start, end), &ru0, &ru1);
+    free(sw->point);
+    sw->point = NULL;
     return status;
 }
 
-#define printd(fmt, ...) \
-	do { if (debug) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
+/*
+ *  MmRpc benchmark (-m on the command line)
+ *
+ *  Calls MxServer_bench<P> back to back over a grid of params=P (the bench
+ *  structure and P - 1 scalars), xlts=X (embedded pointers the kernel
+ *  translates, each to a buffer of its own) and size=S (bytes the remote
+ *  reads from every buffer), calls=N per point. Both shared buffers are
+ *  registered once with MmRpc_use() and the call context of a point is built
+ *  once, so a point times MmRpc_call() and nothing else. The return value,
+ *  the sum of the scalars and of the words read, is checked on every call.
+ */
+#define Mx_Fxn_bench(params)    (0x80000000 | (params))
+
+typedef struct RpcBench {
+    struct omap_bo *bo;         /* the Mx_Bench */
+    struct omap_bo *bufBo;      /* MX_BENCH_MAX_XLTS buffers of bufSize */
+    Mx_Bench *bench;
+    uint32_t *buf;
+    unsigned int bufSize;
+    MmRpc_BufDesc desc[2];
+    int used;
+} RpcBench;
+
+static int rpc_key(const char *key, int value)
+{
+    if (strcmp(key, "params") == 0) {
+        return value < 1 || value > MX_BENCH_MAX_PARAMS;
+    }
+    if (strcmp(key, "xlts") == 0) {
+        return value < 0 || value > MX_BENCH_MAX_XLTS;
+    }
+    if (strcmp(key, "size") == 0) {
+        return value < 0 || value % sizeof(uint32_t) != 0;
+    }
+    if (strcmp(key, "calls") == 0) {
+        return value < 1;
+    }
+    return -1;
+}
 
-int debug=0;
+/* Value of key at a point, def when it is not swept */
+static int rpc_value(const Sweep *sw, const int *value, const char *key, int def)
+{
+    int k = sweep_axis(sw, key);
 
-struct config
+    return k < 0 ? def : value[k];
+}
+
+/* Word j of the bench buffers */
+static uint32_t rpc_word(unsigned int j)
 {
-	int direction;
-	int interval;
-	int msgSize;
-	int msgCount;
-	int procID;
-};
+    return j * 2654435761u;
+}
 
-struct config xyz[MAX_NUM_THREADS];/* [TODO]: Remove Hardcode, Assuming for the time being max threads 100*/
-int linecount = 0;
+static int rpc_bench_create(RpcBench *rb, unsigned int bufSize)
+{
+    unsigned int j;
+
+    rb->bufSize = MAX(bufSize, sizeof(uint32_t));
+    rb->bo = omap_bo_new(dev, sizeof(Mx_Bench), OMAP_BO_WC);
+    rb->bufBo = omap_bo_new(dev, rb->bufSize * MX_BENCH_MAX_XLTS, OMAP_BO_WC);
+    if (rb->bo == NULL || rb->bufBo == NULL) {
+        printf("MmRpc bench: failed to allocate %d byte buffers\n",
+               rb->bufSize * MX_BENCH_MAX_XLTS);
+        return -1;
+    }
+    rb->bench = (Mx_Bench *)omap_bo_map(rb->bo);
+    rb->buf = (uint32_t *)omap_bo_map(rb->bufBo);
+    for (j = 0; j < rb->bufSize * MX_BENCH_MAX_XLTS / sizeof(uint32_t); j++) {
+        rb->buf[j] = rpc_word(j);
+    }
 
-char keylist[5][50] = {
-	"direction",
-	"msgSize",
-	"msgCount",
-	"interval",
-	"procID"
-};
+    /* persistent for every call of the run */
+    rb->desc[0].handle = omap_bo_dmabuf(rb->bo);
+    rb->desc[1].handle = omap_bo_dmabuf(rb->bufBo);
+    if (MmRpc_use(Mx_rpcIpu, MmRpc_BufType_Handle, 2, rb->desc) < 0) {
+        printf("MmRpc bench: MmRpc_use failed\n");
+        return -1;
+    }
+    rb->used = 1;
+    return 0;
+}
 
-int validatekey(char *ptr)
+static void rpc_bench_delete(RpcBench *rb)
 {
-	int i;
-	for(i=0; i<5; i++)
-		if(strcmp(ptr, keylist[i]) == 0)
-			return 0;
+    if (rb->used) {
+        MmRpc_release(Mx_rpcIpu, MmRpc_BufType_Handle, 2, rb->desc);
+    }
+    if (rb->bufBo) {
+        omap_bo_del(rb->bufBo);
+    }
+    if (rb->bo) {
+        omap_bo_del(rb->bo);
+    }
+}
 
-	return 1;
+/* Call context of a point, returns what the remote should answer */
+static uint32_t rpc_bench_ctx(RpcBench *rb, MmRpc_FxnCtx *ctx, MmRpc_Xlt *xlt,
+                              int params, int xlts, int size)
+{
+    uint32_t expected = 0;
+    unsigned int first, j;
+    int i, k;
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->fxn_id = Mx_Fxn_bench(params);
+    ctx->num_params = params;
+    ctx->params[0].type = MmRpc_ParamType_Ptr;
+    ctx->params[0].param.ptr.size = sizeof(Mx_Bench);
+    ctx->params[0].param.ptr.addr = (size_t)rb->bench;
+    ctx->params[0].param.ptr.handle = rb->desc[0].handle;
+    for (i = 1; i < params; i++) {
+        ctx->params[i].type = MmRpc_ParamType_Scalar;
+        ctx->params[i].param.scalar.size = sizeof(uint32_t);
+        ctx->params[i].param.scalar.data = i;
+        expected += i;
+    }
+
+    rb->bench->size = size;
+    rb->bench->numBufs = xlts;
+    ctx->num_xlts = xlts;
+    ctx->xltAry = xlt;
+    for (k = 0; k < xlts; k++) {
+        first = k * rb->bufSize / sizeof(uint32_t);
+        rb->bench->buf[k] = rb->buf + first;
+        xlt[k].index = 0;
+        xlt[k].offset = MmRpc_OFFSET(rb->bench, &rb->bench->buf[k]);
+        xlt[k].base = (size_t)rb->bench->buf[k];
+        xlt[k].handle = rb->desc[1].handle;
+        for (j = 0; j < size / sizeof(uint32_t); j++) {
+            expected += rpc_word(first + j);
+        }
+    }
+    __sync_synchronize();
+    return expected;
 }
 
-/*
-direction: 0-Send, 1-Recv
-msgSize: in bytes(Should be 4 bytes aligned)
-msgCount: number of messages to be exchanged
-interval: in microsecs(us)
-procID: core, Hardcoded to IPU2 for the time being
+static Int rpc_bench_point(RpcBench *rb, SweepPoint *pt, int params, int xlts, int size,
+                           int calls, int warmup)
+{
+    MmRpc_FxnCtx ctx;
+    MmRpc_Xlt xlt[MX_BENCH_MAX_XLTS];
+    uint32_t expected;
+    long long start, t, total = 0;
+    int32_t ret;
+    Int status;
+    int i;
 
-Sample contents of cfg file:");
+    hist_init(&pt->latency);
+    hist_init(&pt->rtt);
+    hist_init(&pt->sendLag);
+    expected = rpc_bench_ctx(rb, &ctx, xlt, params, xlts, size);
 
-#Thread 1
-direction=0, msgSize=6400, msgCount=400, interval=2500, procID=1
-#Thread 2
-direction=1, msgSize=640, msgCount=800, interval=2500, procID=1
+    for (i = 0; i < warmup + calls; i++) {
+        start = nsecs();
+        status = MmRpc_call(Mx_rpcIpu, &ctx, &ret);
+        t = nsecs() - start;
+        if (status < 0) {
+            printf("MmRpc bench: MmRpc_call failed [%d]\n", status);
+            return -1;
+        }
+        if (i < warmup) {
+            continue;
+        }
+        hist_add(&pt->rtt, t);
+        total += t;
+        if ((uint32_t)ret != expected) {
+            pt->errors++;
+        }
+    }
 
-*/
-#define PRINTEXIT {printusage(); exit(1);}
+    pt->expected = pt->msgs = calls;
+    pt->bytes = (unsigned long long)calls * size * xlts;
+    pt->elapsedUs = total / 1000;
+    pt->rate = total ? calls * 1000000000.0 / total : 0.0;
+    pt->mbps = pt->rate * size * xlts / 1000000.0;
+    return 0;
+}
 
-void printusage() {
-    printf("\n --------------------------------------------");
-    printf("\n INCORRECT USAGE !");
-    printf("\n --------------------------------------------");
-    printf("\n ./MessageQZCpy -f <CFG file path>");
-    printf("\n");
-    printf("\n -f : MANDATORY  : Configuration file which contains use-case configurations");
-    printf("\n");
-    printf("\n Sample contents of cfg file:");
-    printf("\n #Thread 1");
-    printf("\n direction=0, msgSize=6400, msgCount=400, interval=2500, procID=1");
-    printf("\n #Thread 2");
-    printf("\n direction=1, msgSize=640, msgCount=800, interval=2500, procID=1");
+static void print_rpc_surface(const Sweep *sw)
+{
+    const SweepPoint *pt;
+    int p;
+
+    printf("\nMmRpc calls, round trip in usecs\n");
+    printf("%-6s %4s %8s %7s %11s %9s %9s %9s %9s %9s %9s %6s\n", "Params", "Xlts",
+           "Size", "Calls", "Calls/s", "MB/s", "p50", "p99", "p99.9", "max",
+           "CPU/call", "Errors");
+    for (p = 0; p < sw->numDone; p++) {
+        pt = &sw->point[p];
+        printf("%-6d %4d %8d %7llu %11.1f %9.2f", rpc_value(sw, pt->value, "params", 1),
+               rpc_value(sw, pt->value, "xlts", 1),
+               rpc_value(sw, pt->value, "size", RPC_BENCH_SIZE), pt->msgs, pt->rate,
+               pt->mbps);
+        print_hist_us(&pt->rtt, 50);
+        print_hist_us(&pt->rtt, 99);
+        print_hist_us(&pt->rtt, 99.9);
+        printf(" %9.1f %9.2f %6llu\n", pt->rtt.max / 1000.0,
+               pt->msgs ? pt->cpuMs * 1000.0 / pt->msgs : 0.0, pt->errors);
+    }
     printf("\n");
 }
 
-
-void add_key_value(char *key, int value)
+/* Runs every point of sw on the MmRpc connection of Mx_initialize() */
+static Int run_rpc_bench(Sweep *sw, const char *cfgPath, const char *resultsPath)
 {
-    if((linecount + 1) < MAX_NUM_THREADS)
-    {
-	printd("%s", "Inside add_key_value\n");
-	
-	if(strcmp(key, "direction") == 0)
-		xyz[linecount].direction = value;
-	else if(strcmp(key, "interval") == 0)
-		xyz[linecount].interval = value;
-	else if(strcmp(key, "msgSize") == 0)
-		xyz[linecount].msgSize = value;
-	else if(strcmp(key, "msgCount") == 0)
-		xyz[linecount].msgCount = value;
-	else if(strcmp(key, "procID") == 0)
-		xyz[linecount].procID = value;
-	else
-		printd("%s", "********** UNKNOWN**********");
+    RpcBench rb = {0};
+    struct timespec start, end;
+    struct rusage ru0, ru1, pt0, pt1;
+    SweepPoint *pt;
+    int value[SWEEP_MAX_AXES];
+    int p, calls, warmup, maxSize = 0;
+    Int status = 0;
+
+    for (p = 0; p < sw->numPoints; p++) {
+        sweep_values(sw, p, value);
+        maxSize = MAX(maxSize, rpc_value(sw, value, "size", RPC_BENCH_SIZE));
+    }
+
+    sw->point = calloc(sw->numPoints, sizeof(SweepPoint));
+    if (sw->point == NULL) {
+        printf("MmRpc bench: no memory for %d points\n", sw->numPoints);
+        return -1;
+    }
+    if (rpc_bench_create(&rb, maxSize) < 0) {
+        status = -1;
+        goto done;
     }
-    else
-    {
-	printf("Max threads limit(%d) exceeded\n",MAX_NUM_THREADS);
-	exit(1);
+
+    getrusage(RUSAGE_SELF, &ru0);
+    clock_gettime(CLOCK_REALTIME, &start);
+    for (p = 0; p < sw->numPoints; p++) {
+        pt = &sw->point[p];
+        sweep_values(sw, p, pt->value);
+        calls = rpc_value(sw, pt->value, "calls", RPC_BENCH_CALLS);
+        warmup = sw->warmup < 0 ? calls / 10 : sw->warmup;
+        printf("Point %d/%d: ", p + 1, sw->numPoints);
+        sweep_label(sw, pt);
+
+        getrusage(RUSAGE_SELF, &pt0);
+        status = rpc_bench_point(&rb, pt, rpc_value(sw, pt->value, "params", 1),
+                                 rpc_value(sw, pt->value, "xlts", 1),
+                                 rpc_value(sw, pt->value, "size", RPC_BENCH_SIZE),
+                                 calls, warmup);
+        getrusage(RUSAGE_SELF, &pt1);
+        if (status < 0) {
+            break;
+        }
+        pt->cpuMs = tv_ms(&pt1.ru_utime) - tv_ms(&pt0.ru_utime) +
+                    tv_ms(&pt1.ru_stime) - tv_ms(&pt0.ru_stime);
+        sw->numDone++;
+        printf(": %.1f calls/s, p50 %.1f us, %llu errors\n", pt->rate,
+               hist_percentile(&pt->rtt, 50) / 1000.0, pt->errors);
     }
+    clock_gettime(CLOCK_REALTIME, &end);
+    getrusage(RUSAGE_SELF, &ru1);
+
+    print_rpc_surface(sw);
+    write_surface(resultsPath, sw, cfgPath, "mmrpc", 0, diff(start, end), &ru0, &ru1);
+
+done:
+    rpc_bench_delete(&rb);
+    free(sw->point);
+    sw->point = NULL;
+    return status;
 }
 
 int main (int argc, char ** argv)
 {
 	stProPerfConfig stMQConfig = {0};
 
-	int ret,i, tempOffsetCtr = 0;
-	struct timespec start, end;
+	int ret,i;
         long elapsed;
 	FILE *fp;
 	char line[512];
-	char tokens[6][512];
+	char tokens[16][512];
 	char path[100];
 	int  temp, flag = 0;
 	char *keyvalue, *pair;
@@ -836,18 +4134,64 @@ int main (int argc, char ** argv)
 
 	Int32 status = 0;
 	int option;
+	int numLoops = 0;
+	char *resultsPath = "MessageQZCpy.json";
+	Reactor *loops = NULL;
+	struct rusage ruStart, ruEnd;
+	Sweep sweep = {0};
+	char *sweepSpec = NULL;
+	Sweep rpcSweep = {0};
+	char *rpcSpec = NULL;
 
 
+    bringup.start = nsecs();
+
     /* Initialize this to turn off verbosity of getopt */
     opterr = 0;
     
-    while ((option = getopt (argc, argv, "f:")) != -1)
+    sweep.warmup = -1;
+    while ((option = getopt (argc, argv, "f:r:j:s:w:b:m:")) != -1)
 	{
 		switch(option)
 		{
 			case 'f':
 				strcpy(path, optarg);
 				break;
+			case 'j':
+				resultsPath = optarg;
+				break;
+			case 'r':
+				numLoops = atoi(optarg);
+				if (numLoops <= 0) {
+					printf("Invalid number of loops %s\n", optarg);
+					PRINTEXIT
+				}
+				break;
+			case 's':
+				sweepSpec = optarg;
+				break;
+			case 'm':
+				rpcSpec = optarg;
+				break;
+			case 'b':
+				if (strcmp(optarg, "wc") == 0) {
+					bufMode = BUF_WC;
+				}
+				else if (strcmp(optarg, "cached") == 0) {
+					bufMode = BUF_CACHED;
+				}
+				else {
+					printf("Invalid buffer mode %s\n", optarg);
+					PRINTEXIT
+				}
+				break;
+			case 'w':
+				sweep.warmup = atoi(optarg);
+				if (sweep.warmup < 0) {
+					printf("Invalid number of warm-up messages %s\n", optarg);
+					PRINTEXIT
+				}
+				break;
 			default:
 				printf("Invalid option.. Exiting\n");
 				PRINTEXIT
@@ -869,9 +4213,10 @@ int main (int argc, char ** argv)
 
 		memset(tokens, 0, sizeof(tokens));
 		i = 0;
+		config_next();
 
 		pair = strtok (line," ,");
-		while (pair != NULL)
+		while (pair != NULL && i < sizeof(tokens)/sizeof(tokens[0]))
 		{
 			printd ("\tPair is = %s\n",pair);
 			strcpy(tokens[i++], pair);
@@ -899,7 +4244,7 @@ int main (int argc, char ** argv)
 				{
 					printd ("\tValue is = %s",keyvalue);
 					printd (" (%d)\n", atoi(keyvalue));
-					add_key_value(key, atoi(keyvalue));
+					config_set(&xyz[linecount], key, atoi(keyvalue));
 					flag = 0;
 				}
 				keyvalue = strtok (NULL, " =");
@@ -913,34 +4258,43 @@ int main (int argc, char ** argv)
 	fclose(fp);
 
 	stMQConfig.procId = COREPROC1; /* [TODO]: Remove Hardcode, Assuming for the time being same proc for all threads */ 
-	stMQConfig.numThreads = linecount;
-        stMQConfig.pThrConfig = (thrConfigs *)malloc(stMQConfig.numThreads * sizeof(struct stProPerfConfig)); 
 
-	for(i = 0; i<stMQConfig.numThreads; i++)
-	{
-                stMQConfig.pThrConfig[i].thread_num = i;
-                stMQConfig.pThrConfig[i].numMessages = xyz[i].msgCount;
-                stMQConfig.pThrConfig[i].numWaitTime = xyz[i].interval;
-                stMQConfig.pThrConfig[i].payloadSize = xyz[i].msgSize;
-                stMQConfig.pThrConfig[i].procId = xyz[i].procID;
-                stMQConfig.pThrConfig[i].config_param = xyz[i].direction;
-
-		printf("Thread [%d] : direction = %d, msgSize = %d, msgCount = %d, interval = %d, procID = %d\n",
-		stMQConfig.pThrConfig[i].thread_num,
-                stMQConfig.pThrConfig[i].config_param,
-                stMQConfig.pThrConfig[i].payloadSize,
-                stMQConfig.pThrConfig[i].numMessages,
-                stMQConfig.pThrConfig[i].numWaitTime,
-                stMQConfig.pThrConfig[i].procId);
-
-                stMQConfig.totalReqPayloadSize += stMQConfig.pThrConfig[i].payloadSize;
+	if (rpcSpec) {
+		rpcSweep.warmup = sweep.warmup;
+		if (sweepSpec || sweep_parse(&rpcSweep, rpcSpec, rpc_key) < 0) {
+			PRINTEXIT
+		}
+		printf("MmRpc bench: %d points\n", rpcSweep.numPoints);
 	}
 
+	if (sweepSpec) {
+		if (linecount == 0 || sweep_parse(&sweep, sweepSpec, sweep_key) < 0) {
+			PRINTEXIT
+		}
+		stMQConfig.totalReqPayloadSize = sweep_size(&sweep, &stMQConfig, numLoops);
+		printf("Sweep: %d points of %d cfg lines, %d byte shared buffer\n",
+		       sweep.numPoints, linecount, stMQConfig.totalReqPayloadSize);
+	}
+	else {
+		stMQConfig.numThreads = linecount;
+		stMQConfig.pThrConfig = (thrConfigs *)calloc(stMQConfig.numThreads, sizeof(thrConfigs));
+
+		for(i = 0; i<stMQConfig.numThreads; i++)
+		{
+			config_stream(&stMQConfig, i, &xyz[i], numLoops, 1);
+		}
+		stMQConfig.totalReqPayloadSize = streams_layout(&stMQConfig);
+	}
+
+    syncClock_init();
+    crc32c_init();
+
     status = Ipc_start();
     if (status < 0) {
         printf ("Ipc_start failed: status = 0x%x\n", status);
         goto exit;
     }
+    bringup.ipc = nsecs();
 
     /* setup rpc connection) */
     status = Mx_initialize(stMQConfig.procId);
@@ -955,73 +4309,102 @@ int main (int argc, char ** argv)
         status = -1;
         goto leave;
     }
+    bringup.rpc = nsecs();
 
-    /* handshake with remote to set numThreads, Message Size,Waittime */
-    MessageQApp_handshake(stMQConfig);
-
-    clock_gettime(CLOCK_REALTIME, &start);
-
-    /* Launch multiple threads: */
-    for (i = 0; i < stMQConfig.numThreads; i++) {
-        /* Create the test threads as per directions: */
-        stMQConfig.pThrConfig[i].boBufPayloadPtr = stMQConfig.bufferPtrRemoteAddr + tempOffsetCtr;
-        stMQConfig.pThrConfig[i].boBufPayloadSize  = stMQConfig.pThrConfig[i].payloadSize;
-	tempOffsetCtr += stMQConfig.pThrConfig[i].payloadSize;
+    if (rpcSpec) {
+        status = run_rpc_bench(&rpcSweep, path, resultsPath);
+        goto leave;
+    }
 
-	if(stMQConfig.pThrConfig[i].config_param == unidirectional_send)
-	{
-		ret = pthread_create(&stMQConfig.pThrConfig[i].thread_id, NULL, &pingThreadFxn_uni_send,
-				   &(stMQConfig.pThrConfig[i]));
-		if (ret) {
-			printf("MessageQMulti: can't spawn thread: %d, %s\n",
-						i, strerror(ret));
-		}
-#if PRINT_DEBUG
-		printf("Sender Thread:%d Direction:%d bufferPtr = 0x%x, bufferPtrRemoteAddr = 0x%x bufferPtrSize = %d\n", 
-			 stMQConfig.pThrConfig[i].thread_num, 
-			 stMQConfig.pThrConfig[i].config_param,
-			 stMQConfig.bufferPtr,
-			 stMQConfig.pThrConfig[i].boBufPayloadPtr,
-			 stMQConfig.pThrConfig[i].boBufPayloadSize);
-#endif
-	}
-	else if(stMQConfig.pThrConfig[i].config_param == unidirectional_recv)
-	{
-			ret = pthread_create(&stMQConfig.pThrConfig[i].thread_id, NULL, &pingThreadFxn_uni_recv,
-							   &(stMQConfig.pThrConfig[i]));
-			if (ret) {
-				printf("MessageQMulti: can't spawn thread: %d, %s\n",
-						i, strerror(ret));
-			}
-#if PRINT_DEBUG
-                printf("Receiver Thread:%d Direction:%d bufferPtr = 0x%x, bufferPtrRemoteAddr = 0x%x bufferPtrSize = %d\n",
-                         stMQConfig.pThrConfig[i].thread_num,
-                         stMQConfig.pThrConfig[i].config_param,
-                         stMQConfig.bufferPtr,
-                         stMQConfig.pThrConfig[i].boBufPayloadPtr,
-                         stMQConfig.pThrConfig[i].boBufPayloadSize);
+    if (sweepSpec) {
+        status = run_sweep(&sweep, &stMQConfig, numLoops, path, resultsPath);
+        goto leave;
+    }
 
-#endif
-	}
+    streams_layout(&stMQConfig);
+    status = run_streams(&stMQConfig, numLoops, &loops, &elapsed, &ruStart, &ruEnd);
+    if (status < 0) {
+        goto leave;
     }
 
-    /* Join all threads: */
+    printf("This use-case run took a total time of %ld msecs to transport totally\n",
+        (elapsed/1000));
+    printf("Process: user %.1f ms, sys %.1f ms, %ld voluntary / %ld involuntary context switches, %s\n",
+           tv_ms(&ruEnd.ru_utime) - tv_ms(&ruStart.ru_utime),
+           tv_ms(&ruEnd.ru_stime) - tv_ms(&ruStart.ru_stime),
+           ruEnd.ru_nvcsw - ruStart.ru_nvcsw, ruEnd.ru_nivcsw - ruStart.ru_nivcsw,
+           numLoops ? "reactor" : "thread per stream");
+
     for (i = 0; i < stMQConfig.numThreads; i++) {
-        ret = pthread_join(stMQConfig.pThrConfig[i].thread_id, NULL);
-        if (ret != 0) {
-            printf("MessageQMulti: failed to join thread: %d, %s\n",
-                    i, strerror(ret));
+        thrConfigs *thr = &stMQConfig.pThrConfig[i];
+
+        if (thr->numMessages == 0) {
+            continue;
         }
-#if PRINT_DEBUG
-        printf("MessageQMulti: Joined with thread %d\n",stMQConfig.pThrConfig[i].thread_num);
-#endif
+        if (thr->config_param == bidirectional) {
+            printf("Thread [%d] : round trips, %d outstanding", thr->thread_num,
+                   thr->outstanding);
+        }
+        else {
+            printf("Thread [%d] : %s %lld ns/msg",
+                   thr->thread_num,
+                   thr->config_param == unidirectional_send ? "alloc" : "free",
+                   per_msg(thr, thr->acquireNs));
+        }
+        if (thr->poolSize && thr->config_param == unidirectional_send) {
+            printf(", %s %d %s, exhausted %d times (%ld us waiting), low water %d",
+                   thr->slots ? "ring" : "pool", thr->poolSize,
+                   thr->slots ? "slots" : "msgs", thr->poolExhausted,
+                   thr->poolWaitUs, thr->poolLowWater);
+        }
+        if (thr->slots && thr->config_param == unidirectional_recv) {
+            printf(", ring %d slots, %d bad slot tags", thr->slots, thr->slotErrors);
+        }
+        if (thr->check) {
+            printf(", check %lld ns/msg", per_msg(thr, thr->checkNs));
+            if (thr->config_param == unidirectional_recv) {
+                printf(" %d bad crc", thr->crcErrors);
+            }
+        }
+        if (thr->copy) {
+            printf(", copy %s %s %lld ns/msg", thr->copy == COPY_INLINE ? "inline" : "bo",
+                   copy_kernel_name(thr->copyKernel), per_msg(thr, thr->copyNs));
+        }
+        if (thr->reactor >= 0) {
+            printf(", reactor loop %d", thr->reactor);
+            if (thr->wakeups && thr->config_param == unidirectional_recv) {
+                printf(", %.1f msgs/pass (max %d)",
+                       (double)thr->msgsDone / thr->wakeups, thr->maxDrain);
+            }
+        }
+        else if (thr->config_param != unidirectional_send) {
+            printf(", recv %s", thr->recvMode == RECV_BLOCK ? "block" :
+                   thr->recvMode == RECV_POLL ? "poll" : "spin");
+            if (thr->recvMode != RECV_BLOCK) {
+                printf(" (%d us) %d polled, %d blocked", thr->spinUs,
+                       thr->spinHits, thr->blocks);
+            }
+            printf(", cpu %.1f ms (%.1f%% of %.1f ms)", thr->cpuNs / 1000000.0,
+                   thr->activeNs ? 100.0 * thr->cpuNs / thr->activeNs : 0.0,
+                   thr->activeNs / 1000000.0);
+            if (thr->wakeups && thr->config_param == unidirectional_recv) {
+                printf(", %.1f msgs/wakeup (max %d)",
+                       (double)thr->msgsDone / thr->wakeups, thr->maxDrain);
+            }
+        }
+        printf("\n");
     }
-    
-    clock_gettime(CLOCK_REALTIME, &end);
-    elapsed = diff(start, end);
 
-    printf("This use-case run took a total time of %ld msecs to transport totally\n",
-        (elapsed/1000));
+    if (numLoops) {
+        print_reactors(loops, numLoops);
+    }
+    print_placement(&stMQConfig);
+    print_rates(&stMQConfig);
+    print_latency(&stMQConfig);
+    print_rtt(&stMQConfig);
+    print_buffer(&stMQConfig);
+    print_startup(&stMQConfig);
+    write_results(resultsPath, &stMQConfig, path, numLoops, elapsed, &ruStart, &ruEnd);
 
         /*** Data Transaction Prototype Function***/
         /* Create the test thread: */
@@ -1032,8 +4415,8 @@ int main (int argc, char ** argv)
         }
 
 leave:
-    free(stMQConfig.pThrConfig);
-    stMQConfig.pThrConfig = NULL;
+    reactor_free(loops, numLoops);
+    streams_free(&stMQConfig);
 
     status = Mx_compute_Release();
     if (status < 0) {
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   crc32c.c
+ *
+ *  @brief  CRC32C (Castagnoli) and the seeded payload pattern of check=1
+ *
+ *  Uses the CRC32 instructions of ARMv8 or SSE4.2 when the compiler
+ *  targets them, slicing-by-8 tables otherwise.
+ *  ============================================================================
+ */
+#include <string.h>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "crc32c.h"
+
+#define CRC32C_POLY     0x82F63B78u     /* reflected */
+#define CHUNK_WORDS     512
+
+static uint32_t table[8][256];
+
+void crc32c_init(void)
+{
+    uint32_t crc;
+    unsigned int i, j;
+
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        }
+        table[0][i] = crc;
+    }
+    for (i = 0; i < 256; i++) {
+        for (j = 1; j < 8; j++) {
+            table[j][i] = (table[j - 1][i] >> 8) ^ table[0][table[j - 1][i] & 0xFF];
+        }
+    }
+}
+
+static inline uint32_t crc32c_u32(uint32_t crc, uint32_t word)
+{
+#if defined(__ARM_FEATURE_CRC32)
+    return __crc32cw(crc, word);
+#elif defined(__SSE4_2__)
+    return _mm_crc32_u32(crc, word);
+#else
+    crc ^= word;
+    return table[3][crc & 0xFF] ^ table[2][(crc >> 8) & 0xFF] ^
+           table[1][(crc >> 16) & 0xFF] ^ table[0][crc >> 24];
+#endif
+}
+
+uint32_t crc32c_update(uint32_t crc, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+    uint32_t lo, hi;
+
+    while (len >= 8) {
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+#if defined(__ARM_FEATURE_CRC32) || defined(__SSE4_2__)
+        crc = crc32c_u32(crc32c_u32(crc, lo), hi);
+#else
+        lo ^= crc;
+        crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^
+              table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+              table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^
+              table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+#endif
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+uint32_t payload_seed(unsigned int thread, unsigned int msgId)
+{
+    uint32_t seed = ((thread << 16) ^ (msgId & 0xFFFF) ^ (msgId >> 16)) * 0x9E3779B1u;
+
+    return seed ? seed : 1;
+}
+
+/* xorshift32 */
+static inline uint32_t pattern_next(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+uint32_t payload_fill(uint32_t *p, unsigned int words, uint32_t seed, uint32_t tag)
+{
+    uint32_t crc = CRC32C_INIT, x = seed;
+    unsigned int i;
+
+    p[0] = tag;
+    crc = crc32c_u32(crc, tag);
+    for (i = 1; i + 1 < words; i++) {
+        x = pattern_next(x);
+        p[i] = x;
+        crc = crc32c_u32(crc, x);
+    }
+    if (words > 1) {
+        p[words - 1] = tag;
+        crc = crc32c_u32(crc, tag);
+    }
+    return ~crc;
+}
+
+uint32_t payload_crc(const uint32_t *p, unsigned int words)
+{
+    uint32_t chunk[CHUNK_WORDS];
+    uint32_t crc = CRC32C_INIT;
+    unsigned int n;
+
+    while (words) {
+        n = words < CHUNK_WORDS ? words : CHUNK_WORDS;
+        memcpy(chunk, p, n * sizeof(uint32_t));
+        crc = crc32c_update(crc, chunk, n * sizeof(uint32_t));
+        p += n;
+        words -= n;
+    }
+    return ~crc;
+}
+
+unsigned int payload_first_bad(const uint32_t *p, unsigned int words,
+                               uint32_t seed, uint32_t tag)
+{
+    uint32_t x = seed;
+    unsigned int i;
+
+    if (p[0] != tag) {
+        return 0;
+    }
+    for (i = 1; i + 1 < words; i++) {
+        x = pattern_next(x);
+        if (p[i] != x) {
+            return i;
+        }
+    }
+    if (words > 1 && p[words - 1] != tag) {
+        return words - 1;
+    }
+    return words;
+}
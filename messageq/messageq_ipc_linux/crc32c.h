@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   crc32c.h
+ *
+ *  @brief  CRC32C (Castagnoli) and the seeded payload pattern of check=1
+ *
+ *  The sender fills a payload with a pattern derived from the stream and
+ *  message id and sends its CRC32C along in the message. The receiver
+ *  recomputes it, so corrupted and stale payloads both show up.
+ *  Payloads are little endian 32-bit words on both cores.
+ *  ============================================================================
+ */
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC32C_INIT     0xFFFFFFFFu
+
+/* Builds the tables of the table driven version, call before any thread */
+void crc32c_init(void);
+
+/* Running CRC, start from CRC32C_INIT and complement the result */
+uint32_t crc32c_update(uint32_t crc, const void *buf, size_t len);
+
+/* Seed of message msgId of stream thread, never 0 */
+uint32_t payload_seed(unsigned int thread, unsigned int msgId);
+
+/*
+ * Writes tag to the first and last word and the pattern of seed in
+ * between, and returns the CRC32C of the words written without reading
+ * them back.
+ */
+uint32_t payload_fill(uint32_t *p, unsigned int words, uint32_t seed, uint32_t tag);
+
+/*
+ * CRC32C of a payload in uncached or write-combined memory. It is read in
+ * chunks with memcpy, whose wide loads are far cheaper there than word
+ * loads, and checksummed from the cached copy.
+ */
+uint32_t payload_crc(const uint32_t *p, unsigned int words);
+
+/* Index of the first word that differs from the pattern, words if none */
+unsigned int payload_first_bad(const uint32_t *p, unsigned int words,
+                               uint32_t seed, uint32_t tag);
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   hist.c
+ *
+ *  @brief  Log-linear latency histogram
+ *
+ *  ============================================================================
+ */
+#include <string.h>
+
+#include "hist.h"
+
+static unsigned int hist_index(uint64_t value)
+{
+    unsigned int shift;
+
+    if (value < HIST_SUB) {
+        return (unsigned int)value;
+    }
+
+    shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+    return ((shift + 1) << HIST_SUB_BITS) + ((value >> shift) & (HIST_SUB - 1));
+}
+
+static uint64_t hist_upper(unsigned int index)
+{
+    unsigned int shift;
+
+    if (index < HIST_SUB) {
+        return index;
+    }
+
+    shift = (index >> HIST_SUB_BITS) - 1;
+    return (((uint64_t)(HIST_SUB + (index & (HIST_SUB - 1))) << shift) +
+            ((uint64_t)1 << shift) - 1);
+}
+
+void hist_init(Hist *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->min = ~(uint64_t)0;
+}
+
+void hist_add(Hist *h, uint64_t value)
+{
+    h->bucket[hist_index(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min) {
+        h->min = value;
+    }
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+void hist_merge(Hist *dst, const Hist *src)
+{
+    unsigned int i;
+
+    if (src->count == 0) {
+        return;
+    }
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        dst->bucket[i] += src->bucket[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->min < dst->min) {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+uint64_t hist_percentile(const Hist *h, double pct)
+{
+    uint64_t rank, seen = 0, value;
+    unsigned int i;
+
+    if (h->count == 0) {
+        return 0;
+    }
+
+    rank = (uint64_t)(pct / 100.0 * h->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen >= rank) {
+            value = hist_upper(i);
+            return value < h->max ? value : h->max;
+        }
+    }
+
+    return h->max;
+}
+
+uint64_t hist_mean(const Hist *h)
+{
+    return h->count ? h->sum / h->count : 0;
+}
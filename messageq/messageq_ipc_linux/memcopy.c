@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   memcopy.c
+ *
+ *  @brief  Copy kernels of the copy paths (copy=1/2, memcpy= in the cfg)
+ *
+ *  The SIMD kernel uses GCC vector types, which become NEON on the A15
+ *  (the build adds -mfpu=neon for this file on ARM) and SSE2 on x86.
+ *  ARMv7 has no non-temporal store, so COPY_NT there is the SIMD loop
+ *  with the source prefetched ahead; x86 uses MOVNTDQ and AArch64 STNP.
+ *  ============================================================================
+ */
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "memcopy.h"
+
+#define PREFETCH_AHEAD  256
+
+typedef uint8_t vec16 __attribute__((vector_size(16)));
+
+static void *copy_libc(void *dst, const void *src, size_t n)
+{
+    return memcpy(dst, src, n);
+}
+
+static void *copy_simd(void *dst, const void *src, size_t n)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    vec16 a, b, c, e;
+
+    while (n >= 64) {
+        __builtin_memcpy(&a, s, 16);
+        __builtin_memcpy(&b, s + 16, 16);
+        __builtin_memcpy(&c, s + 32, 16);
+        __builtin_memcpy(&e, s + 48, 16);
+        __builtin_memcpy(d, &a, 16);
+        __builtin_memcpy(d + 16, &b, 16);
+        __builtin_memcpy(d + 32, &c, 16);
+        __builtin_memcpy(d + 48, &e, 16);
+        s += 64;
+        d += 64;
+        n -= 64;
+    }
+    memcpy(d, s, n);
+    return dst;
+}
+
+static void *copy_nt(void *dst, const void *src, size_t n)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    size_t head;
+
+    /* the non-temporal stores want an aligned destination */
+    head = (16 - ((uintptr_t)d & 15)) & 15;
+    if (head > n) {
+        head = n;
+    }
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    while (n >= 64) {
+#if defined(__SSE2__)
+        __m128i a = _mm_loadu_si128((const __m128i *)s);
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(s + 32));
+        __m128i e = _mm_loadu_si128((const __m128i *)(s + 48));
+
+        _mm_stream_si128((__m128i *)d, a);
+        _mm_stream_si128((__m128i *)(d + 16), b);
+        _mm_stream_si128((__m128i *)(d + 32), c);
+        _mm_stream_si128((__m128i *)(d + 48), e);
+#elif defined(__aarch64__)
+        __asm__ volatile("ldp q0, q1, [%1]\n\t"
+                         "ldp q2, q3, [%1, #32]\n\t"
+                         "stnp q0, q1, [%0]\n\t"
+                         "stnp q2, q3, [%0, #32]"
+                         : : "r"(d), "r"(s) : "v0", "v1", "v2", "v3", "memory");
+#else
+        __builtin_prefetch(s + PREFETCH_AHEAD);
+        copy_simd(d, s, 64);
+#endif
+        s += 64;
+        d += 64;
+        n -= 64;
+    }
+#if defined(__SSE2__)
+    /* order the streaming stores before the message that hands them over */
+    _mm_sfence();
+#endif
+    memcpy(d, s, n);
+    return dst;
+}
+
+CopyFxn copy_kernel(int kernel)
+{
+    switch (kernel) {
+    case COPY_LIBC:
+        return copy_libc;
+    case COPY_SIMD:
+        return copy_simd;
+    case COPY_NT:
+        return copy_nt;
+    }
+    return NULL;
+}
+
+const char *copy_kernel_name(int kernel)
+{
+    switch (kernel) {
+    case COPY_LIBC:
+        return "libc";
+    case COPY_SIMD:
+        return "simd";
+    case COPY_NT:
+#if defined(__SSE2__) || defined(__aarch64__)
+        return "nt";
+#else
+        return "simd+pld";
+#endif
+    }
+    return "?";
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   memcopy.h
+ *
+ *  @brief  Copy kernels of the copy paths (copy=1/2, memcpy= in the cfg)
+ *
+ *  The copy paths move the payload itself instead of passing a pointer to
+ *  it, so the copy kernel is part of what is measured. All kernels take
+ *  any alignment and length.
+ *  ============================================================================
+ */
+#ifndef MEMCOPY_H
+#define MEMCOPY_H
+
+#include <stddef.h>
+
+enum CopyKernel {
+    COPY_LIBC = 0,  /* memcpy() of the C library */
+    COPY_SIMD,      /* 64 bytes per iteration in 128-bit NEON/SSE2 registers */
+    COPY_NT         /* as COPY_SIMD with non-temporal stores, see memcopy.c */
+};
+
+typedef void *(*CopyFxn)(void *dst, const void *src, size_t n);
+
+/* Kernel for a CopyKernel, NULL if there is no such kernel */
+CopyFxn copy_kernel(int kernel);
+
+/* Short name of the kernel as built for this CPU */
+const char *copy_kernel_name(int kernel);
+
+#endif
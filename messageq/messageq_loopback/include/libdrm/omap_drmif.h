@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== omap_drmif.h ========
+ *  Loopback shim: omap_bo buffers are carved from the shared arena, the
+ *  dma-buf handle is a descriptor the MmRpc shim can look up. It is a real
+ *  udmabuf for OMAP_BO_CACHED buffers when /dev/udmabuf can be opened.
+ */
+#ifndef __OMAP_DRMIF_H__
+#define __OMAP_DRMIF_H__
+
+#include <stdint.h>
+
+struct omap_device;
+struct omap_bo;
+
+int drmOpen(const char *name, const char *busid);
+int drmClose(int fd);
+
+struct omap_device *omap_device_new(int fd);
+void omap_device_del(struct omap_device *dev);
+
+struct omap_bo *omap_bo_new(struct omap_device *dev, uint32_t size,
+        uint32_t flags);
+void omap_bo_del(struct omap_bo *bo);
+void *omap_bo_map(struct omap_bo *bo);
+uint32_t omap_bo_size(struct omap_bo *bo);
+int omap_bo_dmabuf(struct omap_bo *bo);
+int omap_bo_cpu_prep(struct omap_bo *bo, int op);
+int omap_bo_cpu_fini(struct omap_bo *bo, int op);
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== MessageQ.h ========
+ *  Loopback shim: the MessageQ calls used by the examples, backed by a
+ *  memfd arena shared between the host process and the remote companion.
+ *  Message headers have the same layout as the real IPC ones.
+ */
+#ifndef ti_ipc_MessageQ__include
+#define ti_ipc_MessageQ__include
+
+#include <ti/ipc/Std.h>
+
+#define MessageQ_S_SUCCESS              0
+#define MessageQ_E_FAIL                 (-1)
+#define MessageQ_E_INVALIDARG           (-2)
+#define MessageQ_E_MEMORY               (-3)
+#define MessageQ_E_ALREADYEXISTS        (-4)
+#define MessageQ_E_NOTFOUND             (-5)
+#define MessageQ_E_TIMEOUT              (-6)
+#define MessageQ_E_INVALIDSTATE         (-7)
+#define MessageQ_E_OSFAILURE            (-8)
+#define MessageQ_E_RESOURCE             (-9)
+#define MessageQ_E_INVALIDMSG           (-11)
+#define MessageQ_E_UNBLOCKED            (-19)
+
+#define MessageQ_FOREVER                (~(0))
+#define MessageQ_INVALIDMESSAGEQ        (0xFFFF)
+
+#define MessageQ_NORMALPRI              (0)
+#define MessageQ_HIGHPRI                (1)
+#define MessageQ_URGENTPRI              (3)
+
+typedef UInt32 MessageQ_QueueId;
+typedef UInt16 MessageQ_QueueIndex;
+
+typedef struct {
+    Bits32  reserved0;      /* next message in a queue, arena offset */
+    Bits32  reserved1;
+    Bits32  msgSize;
+    Bits16  flags;
+    Bits16  msgId;
+    Bits16  dstId;
+    Bits16  dstProc;
+    Bits16  replyId;
+    Bits16  replyProc;
+    Bits16  srcProc;
+    Bits16  heapId;
+    Bits16  seqNum;
+    Bits16  reserved;
+} MessageQ_MsgHeader;
+
+typedef MessageQ_MsgHeader *MessageQ_Msg;
+
+typedef struct MessageQ_Object *MessageQ_Handle;
+
+typedef struct {
+    Void *synchronizer;
+} MessageQ_Params;
+
+#define MessageQ_getDstQueue(msg) \
+        (((MessageQ_QueueId)((MessageQ_Msg)(msg))->dstProc << 16) | \
+         ((MessageQ_Msg)(msg))->dstId)
+
+#define MessageQ_getMsgId(msg)      (((MessageQ_Msg)(msg))->msgId)
+#define MessageQ_getMsgSize(msg)    (((MessageQ_Msg)(msg))->msgSize)
+#define MessageQ_getMsgPri(msg)     (((MessageQ_Msg)(msg))->flags & 0x3)
+#define MessageQ_getProcId(queueId) ((UInt16)((queueId) >> 16))
+
+#define MessageQ_getReplyQueue(msg) \
+        (((MessageQ_Msg)(msg))->replyId != (UInt16)MessageQ_INVALIDMESSAGEQ ? \
+         (((MessageQ_QueueId)((MessageQ_Msg)(msg))->replyProc << 16) | \
+          ((MessageQ_Msg)(msg))->replyId) : MessageQ_INVALIDMESSAGEQ)
+
+#define MessageQ_setMsgId(msg, id)  ((MessageQ_Msg)(msg))->msgId = (id)
+#define MessageQ_setMsgPri(msg, priority) \
+        (((MessageQ_Msg)(msg))->flags = \
+         (((MessageQ_Msg)(msg))->flags & ~0x3) | ((priority) & 0x3))
+
+Void MessageQ_Params_init(MessageQ_Params *params);
+
+MessageQ_Handle MessageQ_create(String name, const MessageQ_Params *params);
+Int MessageQ_delete(MessageQ_Handle *handlePtr);
+Int MessageQ_open(String name, MessageQ_QueueId *queueId);
+Int MessageQ_close(MessageQ_QueueId *queueId);
+
+MessageQ_Msg MessageQ_alloc(UInt16 heapId, UInt32 size);
+Int MessageQ_free(MessageQ_Msg msg);
+
+Int MessageQ_put(MessageQ_QueueId queueId, MessageQ_Msg msg);
+Int MessageQ_get(MessageQ_Handle handle, MessageQ_Msg *msg, UInt timeout);
+Int MessageQ_count(MessageQ_Handle handle);
+Void MessageQ_unblock(MessageQ_Handle handle);
+
+MessageQ_QueueId MessageQ_getQueueId(MessageQ_Handle handle);
+Void MessageQ_setReplyQueue(MessageQ_Handle handle, MessageQ_Msg msg);
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== Std.h ========
+ *  Loopback shim: basic types used by the TI IPC headers
+ */
+#ifndef ti_ipc_Std__include
+#define ti_ipc_Std__include
+
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+
+typedef char            Char;
+typedef unsigned char   UChar;
+typedef short           Short;
+typedef unsigned short  UShort;
+typedef int             Int;
+typedef unsigned int    UInt;
+typedef long            Long;
+typedef unsigned long   ULong;
+typedef unsigned short  Bool;
+typedef void            Void;
+typedef void           *Ptr;
+typedef char           *String;
+typedef uintptr_t       UArg;
+typedef size_t          SizeT;
+
+typedef int8_t          Int8;
+typedef int16_t         Int16;
+typedef int32_t         Int32;
+typedef uint8_t         UInt8;
+typedef uint16_t        UInt16;
+typedef uint32_t        UInt32;
+typedef uint16_t        Bits16;
+typedef uint32_t        Bits32;
+
+#define TRUE            1
+#define FALSE           0
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== MmRpc.h ========
+ *  Loopback shim: MmRpc calls are carried to the remote companion through
+ *  the shared arena. Embedded pointers are translated to the remote's
+ *  mapping for the duration of the call, like the rpmsg-rpc driver does.
+ */
+#ifndef ti_ipc_mm_MmRpc__include
+#define ti_ipc_mm_MmRpc__include
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MmRpc_S_SUCCESS         (0)
+#define MmRpc_E_FAIL            (-1)
+#define MmRpc_E_INVALIDPARAM    (-2)
+#define MmRpc_E_NOMEM           (-3)
+#define MmRpc_E_SYS             (-4)
+
+#define MmRpc_MAXPARAMS         (10)
+#define MmRpc_MAXTRANSLATIONS   (1024)
+
+#define MmRpc_OFFSET(base, field) ((size_t)(field) - (size_t)(base))
+
+typedef enum {
+    MmRpc_ParamType_Scalar = 1,
+    MmRpc_ParamType_Ptr,
+    MmRpc_ParamType_OffPtr,
+    MmRpc_ParamType_Elem
+} MmRpc_ParamType;
+
+typedef struct {
+    MmRpc_ParamType type;
+    union {
+        struct {
+            size_t size;
+            size_t data;
+        } scalar;
+        struct {
+            size_t size;
+            size_t addr;
+            size_t handle;
+        } ptr;
+        struct {
+            size_t size;
+            size_t offset;
+            size_t base;
+            size_t handle;
+        } offPtr;
+    } param;
+} MmRpc_Param;
+
+typedef struct {
+    uint32_t index;
+    ptrdiff_t offset;
+    size_t base;
+    size_t handle;
+} MmRpc_Xlt;
+
+typedef struct {
+    uint32_t fxn_id;
+    uint32_t num_params;
+    MmRpc_Param params[MmRpc_MAXPARAMS];
+    uint32_t num_xlts;
+    MmRpc_Xlt *xltAry;
+} MmRpc_FxnCtx;
+
+typedef enum {
+    MmRpc_BufType_Handle,
+    MmRpc_BufType_Ptr
+} MmRpc_BufType;
+
+typedef struct {
+    union {
+        size_t handle;
+        struct {
+            size_t addr;
+            size_t size;
+        } ptr;
+    };
+} MmRpc_BufDesc;
+
+typedef struct MmRpc_Object *MmRpc_Handle;
+
+typedef struct {
+    int reserved;
+} MmRpc_Params;
+
+void MmRpc_Params_init(MmRpc_Params *params);
+int MmRpc_create(const char *service, const MmRpc_Params *params,
+        MmRpc_Handle *handlePtr);
+int MmRpc_delete(MmRpc_Handle *handlePtr);
+int MmRpc_call(MmRpc_Handle handle, MmRpc_FxnCtx *ctx, int32_t *ret);
+int MmRpc_use(MmRpc_Handle handle, MmRpc_BufType type, int num,
+        MmRpc_BufDesc *desc);
+int MmRpc_release(MmRpc_Handle handle, MmRpc_BufType type, int num,
+        MmRpc_BufDesc *desc);
+
+#endif
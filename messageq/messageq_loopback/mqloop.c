@@ -0,0 +1,1038 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   mqloop.c
+ *
+ *  @brief  Loopback implementation of the MessageQ, MultiProc, MmRpc and
+ *          omap_bo calls used by MessageQZCpy
+ *
+ *  Ipc_start() creates a memfd arena and execs the remote companion with
+ *  the descriptor inherited. Queues are FIFO lists of arena messages with
+ *  a futex sequence word to sleep on; messages and buffers come from a
+ *  power-of-two size class allocator in the same arena. Cached omap_bo
+ *  buffers are exported through /dev/udmabuf when it is there, so their
+ *  DMA-BUF sync ioctls reach the kernel as they would on the target.
+ *  ============================================================================
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#ifdef __has_include
+#if __has_include(<linux/udmabuf.h>)
+#include <linux/udmabuf.h>
+#endif
+#endif
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include <ti/ipc/Std.h>
+#include <ti/ipc/Ipc.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/ipc/MultiProc.h>
+#include <ti/ipc/mm/MmRpc.h>
+#include <omap/omap_drm.h>
+#include <libdrm/omap_drmif.h>
+
+#include "mqloop.h"
+
+#define MQLOOP_SPIN         200
+#define MQLOOP_READY_SECS   10
+#define MQLOOP_MAX_BOS      1024
+
+struct MessageQ_Object {
+    uint32_t index;
+    MessageQ_QueueId queueId;
+};
+
+struct MmRpc_Object {
+    struct mqloop_rpc *rpc;
+};
+
+struct omap_device {
+    int fd;
+};
+
+struct omap_bo {
+    void *ptr;
+    uint32_t size;
+    uint32_t flags;
+    int fd;
+};
+
+static struct mqloop_arena *arena = NULL;
+static int arenaFd = -1;
+static UInt16 selfId = 0;
+static pid_t remotePid = 0;
+
+static struct omap_bo *boTable[MQLOOP_MAX_BOS];
+static pthread_mutex_t boLock = PTHREAD_MUTEX_INITIALIZER;
+
+static String procNames[] = { "HOST", "IPU2", "IPU1", "DSP2", "DSP1" };
+#define NUM_PROCS   (sizeof(procNames) / sizeof(procNames[0]))
+
+/*
+ *  ======== futex helpers ========
+ */
+static int futex_wait(uint32_t *addr, uint32_t val, const struct timespec *rel)
+{
+    return syscall(SYS_futex, addr, FUTEX_WAIT, val, rel, NULL, 0);
+}
+
+static void futex_wake(uint32_t *addr, int count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+/* 0 = free, 1 = locked, 2 = locked with sleepers */
+static void lock_acquire(uint32_t *l)
+{
+    uint32_t c;
+    int spin;
+
+    for (spin = 0; spin < MQLOOP_SPIN; spin++) {
+        c = 0;
+        if (__atomic_compare_exchange_n(l, &c, 1, 0, __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    c = __atomic_exchange_n(l, 2, __ATOMIC_ACQUIRE);
+    while (c != 0) {
+        futex_wait(l, 2, NULL);
+        c = __atomic_exchange_n(l, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+static void lock_release(uint32_t *l)
+{
+    if (__atomic_exchange_n(l, 0, __ATOMIC_RELEASE) == 2) {
+        futex_wake(l, 1);
+    }
+}
+
+/*
+ *  ======== arena helpers ========
+ */
+static inline void *arena_ptr(uint32_t off)
+{
+    return (char *)arena + off;
+}
+
+static inline uint32_t arena_off(const void *ptr)
+{
+    return (uint32_t)((const char *)ptr - (const char *)arena);
+}
+
+static int arena_contains(const void *ptr)
+{
+    return arena && (const char *)ptr >= (const char *)arena &&
+           (const char *)ptr < (const char *)arena + arena->size;
+}
+
+uint32_t mqloop_devaddr(const void *ptr)
+{
+    return MQLOOP_DEVADDR_BASE + arena_off(ptr);
+}
+
+void *mqloop_ptr(uint32_t devaddr)
+{
+    return arena_ptr(devaddr - MQLOOP_DEVADDR_BASE);
+}
+
+int mqloop_shutdown(void)
+{
+    return arena == NULL || arena->shutdown;
+}
+
+static void *block_alloc(uint64_t size)
+{
+    uint32_t cls = 6, off, *hdr;
+
+    while (((uint64_t)1 << cls) < size + MQLOOP_BLOCK_HDR) {
+        cls++;
+    }
+    if (cls >= MQLOOP_NUM_CLASSES) {
+        return NULL;
+    }
+
+    lock_acquire(&arena->heap_lock);
+    off = arena->free_list[cls];
+    if (off) {
+        arena->free_list[cls] = ((uint32_t *)arena_ptr(off))[2];
+    }
+    else if (arena->brk + ((uint64_t)1 << cls) <= arena->size) {
+        off = (uint32_t)arena->brk;
+        arena->brk += (uint64_t)1 << cls;
+    }
+    lock_release(&arena->heap_lock);
+
+    if (off == 0) {
+        return NULL;
+    }
+
+    hdr = arena_ptr(off);
+    hdr[0] = MQLOOP_MAGIC;
+    hdr[1] = cls;
+    return (char *)hdr + MQLOOP_BLOCK_HDR;
+}
+
+static int block_free(void *ptr)
+{
+    uint32_t *hdr = (uint32_t *)((char *)ptr - MQLOOP_BLOCK_HDR);
+    uint32_t cls = hdr[1];
+
+    if (!arena_contains(ptr) || hdr[0] != MQLOOP_MAGIC) {
+        return -1;
+    }
+
+    hdr[0] = 0;
+    lock_acquire(&arena->heap_lock);
+    hdr[2] = arena->free_list[cls];
+    arena->free_list[cls] = arena_off(hdr);
+    lock_release(&arena->heap_lock);
+
+    return 0;
+}
+
+static int arena_map(int fd, uint64_t size)
+{
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (base == MAP_FAILED) {
+        perror("mqloop: mmap");
+        return -1;
+    }
+    arena = base;
+    arenaFd = fd;
+    return 0;
+}
+
+static int remote_wait_ready(void)
+{
+    struct timespec rel = { 0, 100000000 };
+    int i;
+
+    for (i = 0; i < MQLOOP_READY_SECS * 10 && !arena->remote_ready; i++) {
+        futex_wait(&arena->remote_ready, 0, &rel);
+        if (remotePid && waitpid(remotePid, NULL, WNOHANG) == remotePid) {
+            remotePid = 0;
+            break;
+        }
+    }
+    return arena->remote_ready ? 0 : -1;
+}
+
+static void remote_path(char *path, size_t len)
+{
+    char *env = getenv("MQLOOP_REMOTE");
+    ssize_t n;
+    char *slash;
+
+    if (env) {
+        snprintf(path, len, "%s", env);
+        return;
+    }
+
+    /* default: next to the running executable */
+    n = readlink("/proc/self/exe", path, len - 1);
+    path[n > 0 ? n : 0] = '\0';
+    slash = strrchr(path, '/');
+    snprintf(slash ? slash + 1 : path, len - (slash ? slash + 1 - path : 0),
+             "mqloop_remote");
+}
+
+/*
+ *  ======== Ipc ========
+ */
+Int Ipc_start(Void)
+{
+    char path[PATH_MAX], fdArg[16], *env;
+    uint64_t size = (uint64_t)MQLOOP_DEFAULT_SIZE_MB << 20;
+    int fd;
+
+    if (arena) {
+        return Ipc_S_SUCCESS;
+    }
+
+    env = getenv("MQLOOP_ARENA_MB");
+    if (env && atoi(env) > 0 && atoi(env) < 4096) {
+        size = (uint64_t)atoi(env) << 20;
+    }
+
+    fd = memfd_create("mqloop", MFD_ALLOW_SEALING);
+    if (fd < 0 || ftruncate(fd, size) < 0 || arena_map(fd, size) < 0) {
+        perror("mqloop: arena");
+        return Ipc_E_FAIL;
+    }
+    /* udmabuf only exports memfds that cannot shrink */
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK);
+
+    arena->magic = MQLOOP_MAGIC;
+    arena->size = size;
+    arena->brk = (sizeof(*arena) + 4095) & ~(uint64_t)4095;
+    selfId = 0;
+
+    remote_path(path, sizeof(path));
+    if (strcmp(path, "none") == 0) {
+        printf("mqloop: start the remote with: mqloop_remote /proc/%d/fd/%d\n",
+               getpid(), fd);
+    }
+    else {
+        snprintf(fdArg, sizeof(fdArg), "%d", fd);
+        remotePid = fork();
+        if (remotePid == 0) {
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            execl(path, path, fdArg, (char *)NULL);
+            fprintf(stderr, "mqloop: cannot exec %s: %s\n", path, strerror(errno));
+            _exit(127);
+        }
+        if (remotePid < 0) {
+            perror("mqloop: fork");
+            return Ipc_E_FAIL;
+        }
+    }
+
+    if (remote_wait_ready() < 0) {
+        fprintf(stderr, "mqloop: remote companion did not attach\n");
+        Ipc_stop();
+        return Ipc_E_FAIL;
+    }
+
+    return Ipc_S_SUCCESS;
+}
+
+Int Ipc_stop(Void)
+{
+    int i;
+
+    if (arena == NULL) {
+        return Ipc_E_FAIL;
+    }
+
+    arena->shutdown = 1;
+    for (i = 0; i < MQLOOP_MAX_QUEUES; i++) {
+        __atomic_add_fetch(&arena->queue[i].seq, 1, __ATOMIC_RELEASE);
+        futex_wake(&arena->queue[i].seq, INT_MAX);
+    }
+    for (i = 0; i < MQLOOP_MAX_SERVICES; i++) {
+        futex_wake(&arena->rpc[i].state, INT_MAX);
+    }
+
+    if (remotePid > 0) {
+        waitpid(remotePid, NULL, 0);
+        remotePid = 0;
+    }
+
+    munmap(arena, arena->size);
+    close(arenaFd);
+    arena = NULL;
+    arenaFd = -1;
+
+    return Ipc_S_SUCCESS;
+}
+
+int mqloop_attach(int fd, UInt16 procId)
+{
+    struct mqloop_arena hdr;
+
+    if (pread(fd, &hdr, sizeof(hdr.magic) + sizeof(hdr.shutdown) + sizeof(hdr.size), 0) <= 0 ||
+        hdr.magic != MQLOOP_MAGIC) {
+        fprintf(stderr, "mqloop: descriptor %d is not an mqloop arena\n", fd);
+        return -1;
+    }
+    if (arena_map(fd, hdr.size) < 0) {
+        return -1;
+    }
+
+    selfId = procId;
+    arena->remote_base = (uint64_t)(uintptr_t)arena;
+    __atomic_store_n(&arena->remote_ready, 1, __ATOMIC_RELEASE);
+    futex_wake(&arena->remote_ready, INT_MAX);
+
+    return 0;
+}
+
+void mqloop_detach(void)
+{
+    if (arena) {
+        munmap(arena, arena->size);
+        close(arenaFd);
+        arena = NULL;
+    }
+}
+
+/*
+ *  ======== MultiProc ========
+ */
+String MultiProc_getName(UInt16 id)
+{
+    return id < NUM_PROCS ? procNames[id] : NULL;
+}
+
+UInt16 MultiProc_getId(String name)
+{
+    UInt16 i;
+
+    for (i = 0; name && i < NUM_PROCS; i++) {
+        if (strcmp(name, procNames[i]) == 0) {
+            return i;
+        }
+    }
+    return MultiProc_INVALIDID;
+}
+
+UInt16 MultiProc_self(Void)
+{
+    return selfId;
+}
+
+UInt16 MultiProc_getNumProcessors(Void)
+{
+    return NUM_PROCS;
+}
+
+/*
+ *  ======== MessageQ ========
+ */
+Void MessageQ_Params_init(MessageQ_Params *params)
+{
+    params->synchronizer = NULL;
+}
+
+static struct mqloop_queue *find_queue(const char *name)
+{
+    int i;
+
+    for (i = 0; i < MQLOOP_MAX_QUEUES; i++) {
+        if (arena->queue[i].used && strcmp(arena->queue[i].name, name) == 0) {
+            return &arena->queue[i];
+        }
+    }
+    return NULL;
+}
+
+MessageQ_Handle MessageQ_create(String name, const MessageQ_Params *params)
+{
+    struct MessageQ_Object *obj;
+    struct mqloop_queue *q = NULL;
+    int i;
+
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    obj = malloc(sizeof(*obj));
+    if (obj == NULL) {
+        return NULL;
+    }
+
+    lock_acquire(&arena->table_lock);
+    if (name == NULL || find_queue(name) == NULL) {
+        for (i = 0; i < MQLOOP_MAX_QUEUES; i++) {
+            if (!arena->queue[i].used) {
+                q = &arena->queue[i];
+                memset(q, 0, offsetof(struct mqloop_queue, seq));
+                snprintf(q->name, sizeof(q->name), "%s", name ? name : "");
+                q->procId = selfId;
+                q->used = 1;
+                break;
+            }
+        }
+    }
+    lock_release(&arena->table_lock);
+
+    if (q == NULL) {
+        free(obj);
+        return NULL;
+    }
+
+    obj->index = q - arena->queue;
+    obj->queueId = ((MessageQ_QueueId)selfId << 16) | obj->index;
+    return obj;
+}
+
+Int MessageQ_delete(MessageQ_Handle *handlePtr)
+{
+    struct mqloop_queue *q;
+    MessageQ_Msg msg;
+
+    if (handlePtr == NULL || *handlePtr == NULL || arena == NULL) {
+        return MessageQ_E_INVALIDARG;
+    }
+
+    q = &arena->queue[(*handlePtr)->index];
+    lock_acquire(&arena->table_lock);
+    lock_acquire(&q->lock);
+    while (q->head) {
+        msg = arena_ptr(q->head);
+        q->head = msg->reserved0;
+        block_free(msg);
+    }
+    q->used = 0;
+    q->name[0] = '\0';
+    q->tail = q->count = 0;
+    lock_release(&q->lock);
+    lock_release(&arena->table_lock);
+
+    free(*handlePtr);
+    *handlePtr = NULL;
+    return MessageQ_S_SUCCESS;
+}
+
+Int MessageQ_open(String name, MessageQ_QueueId *queueId)
+{
+    struct mqloop_queue *q;
+
+    if (arena == NULL) {
+        return MessageQ_E_INVALIDSTATE;
+    }
+
+    lock_acquire(&arena->table_lock);
+    q = find_queue(name);
+    if (q) {
+        *queueId = ((MessageQ_QueueId)q->procId << 16) | (q - arena->queue);
+    }
+    lock_release(&arena->table_lock);
+
+    return q ? MessageQ_S_SUCCESS : MessageQ_E_NOTFOUND;
+}
+
+Int MessageQ_close(MessageQ_QueueId *queueId)
+{
+    *queueId = MessageQ_INVALIDMESSAGEQ;
+    return MessageQ_S_SUCCESS;
+}
+
+MessageQ_Msg MessageQ_alloc(UInt16 heapId, UInt32 size)
+{
+    MessageQ_Msg msg;
+
+    if (arena == NULL || size < sizeof(MessageQ_MsgHeader)) {
+        return NULL;
+    }
+
+    msg = block_alloc(size);
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    memset(msg, 0, sizeof(*msg));
+    msg->msgSize = size;
+    msg->replyId = (UInt16)MessageQ_INVALIDMESSAGEQ;
+    msg->replyProc = (UInt16)MessageQ_INVALIDMESSAGEQ;
+    msg->srcProc = selfId;
+    msg->heapId = heapId;
+    return msg;
+}
+
+Int MessageQ_free(MessageQ_Msg msg)
+{
+    return block_free(msg) == 0 ? MessageQ_S_SUCCESS : MessageQ_E_INVALIDMSG;
+}
+
+Int MessageQ_put(MessageQ_QueueId queueId, MessageQ_Msg msg)
+{
+    uint32_t index = queueId & 0xFFFF;
+    struct mqloop_queue *q;
+    uint32_t waiters;
+
+    if (arena == NULL || index >= MQLOOP_MAX_QUEUES || !arena_contains(msg)) {
+        return MessageQ_E_INVALIDARG;
+    }
+    q = &arena->queue[index];
+
+    msg->dstId = index;
+    msg->dstProc = queueId >> 16;
+    msg->reserved0 = 0;
+
+    lock_acquire(&q->lock);
+    if (!q->used) {
+        lock_release(&q->lock);
+        return MessageQ_E_NOTFOUND;
+    }
+    if (q->tail) {
+        ((MessageQ_Msg)arena_ptr(q->tail))->reserved0 = arena_off(msg);
+    }
+    else {
+        q->head = arena_off(msg);
+    }
+    q->tail = arena_off(msg);
+    q->count++;
+    q->seq++;
+    waiters = q->waiters;
+    lock_release(&q->lock);
+
+    if (waiters) {
+        futex_wake(&q->seq, 1);
+    }
+    return MessageQ_S_SUCCESS;
+}
+
+Int MessageQ_get(MessageQ_Handle handle, MessageQ_Msg *msg, UInt timeout)
+{
+    struct mqloop_queue *q = &arena->queue[handle->index];
+    struct timespec deadline, now, rel, *relp = NULL;
+    uint32_t seq;
+    long long left;
+
+    if (timeout != (UInt)MessageQ_FOREVER && timeout != 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout / 1000000;
+        deadline.tv_nsec += (timeout % 1000000) * 1000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    for (;;) {
+        lock_acquire(&q->lock);
+        if (q->head) {
+            *msg = arena_ptr(q->head);
+            q->head = (*msg)->reserved0;
+            if (q->head == 0) {
+                q->tail = 0;
+            }
+            q->count--;
+            lock_release(&q->lock);
+            return MessageQ_S_SUCCESS;
+        }
+        if (arena->shutdown || q->unblocked) {
+            q->unblocked = 0;
+            lock_release(&q->lock);
+            return MessageQ_E_UNBLOCKED;
+        }
+        if (timeout == 0) {
+            lock_release(&q->lock);
+            return MessageQ_E_TIMEOUT;
+        }
+        seq = q->seq;
+        q->waiters++;
+        lock_release(&q->lock);
+
+        if (timeout != (UInt)MessageQ_FOREVER) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            left = (deadline.tv_sec - now.tv_sec) * 1000000000LL +
+                   (deadline.tv_nsec - now.tv_nsec);
+            if (left <= 0) {
+                __atomic_sub_fetch(&q->waiters, 1, __ATOMIC_RELAXED);
+                timeout = 0;
+                continue;
+            }
+            rel.tv_sec = left / 1000000000LL;
+            rel.tv_nsec = left % 1000000000LL;
+            relp = &rel;
+        }
+
+        futex_wait(&q->seq, seq, relp);
+        __atomic_sub_fetch(&q->waiters, 1, __ATOMIC_RELAXED);
+    }
+}
+
+Int MessageQ_count(MessageQ_Handle handle)
+{
+    return arena->queue[handle->index].count;
+}
+
+Void MessageQ_unblock(MessageQ_Handle handle)
+{
+    struct mqloop_queue *q = &arena->queue[handle->index];
+
+    lock_acquire(&q->lock);
+    q->unblocked = 1;
+    q->seq++;
+    lock_release(&q->lock);
+    futex_wake(&q->seq, INT_MAX);
+}
+
+MessageQ_QueueId MessageQ_getQueueId(MessageQ_Handle handle)
+{
+    return handle->queueId;
+}
+
+Void MessageQ_setReplyQueue(MessageQ_Handle handle, MessageQ_Msg msg)
+{
+    msg->replyId = handle->queueId & 0xFFFF;
+    msg->replyProc = handle->queueId >> 16;
+}
+
+/*
+ *  ======== omap_bo ========
+ */
+int drmOpen(const char *name, const char *busid)
+{
+    return open("/dev/null", O_RDWR);
+}
+
+int drmClose(int fd)
+{
+    return close(fd);
+}
+
+struct omap_device *omap_device_new(int fd)
+{
+    struct omap_device *dev = malloc(sizeof(*dev));
+
+    if (dev) {
+        dev->fd = fd;
+    }
+    return dev;
+}
+
+void omap_device_del(struct omap_device *dev)
+{
+    free(dev);
+}
+
+static struct omap_bo *bo_lookup(size_t handle)
+{
+    struct omap_bo *bo = NULL;
+    int i;
+
+    pthread_mutex_lock(&boLock);
+    for (i = 0; i < MQLOOP_MAX_BOS; i++) {
+        if (boTable[i] && (size_t)boTable[i]->fd == handle) {
+            bo = boTable[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&boLock);
+    return bo;
+}
+
+/* A dma-buf over the arena pages of a buffer, -1 without /dev/udmabuf */
+static int bo_udmabuf(void *ptr, uint32_t size)
+{
+#ifdef UDMABUF_CREATE
+    struct udmabuf_create create;
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    uint64_t start = arena_off(ptr) & ~(page - 1);
+    int dev, fd;
+
+    dev = open("/dev/udmabuf", O_RDWR | O_CLOEXEC);
+    if (dev < 0) {
+        return -1;
+    }
+
+    memset(&create, 0, sizeof(create));
+    create.memfd = arenaFd;
+    create.flags = UDMABUF_FLAGS_CLOEXEC;
+    create.offset = start;
+    create.size = ((arena_off(ptr) + size + page - 1) & ~(page - 1)) - start;
+    fd = ioctl(dev, UDMABUF_CREATE, &create);
+    close(dev);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+struct omap_bo *omap_bo_new(struct omap_device *dev, uint32_t size,
+        uint32_t flags)
+{
+    struct omap_bo *bo;
+    int i;
+
+    if (arena == NULL || (bo = calloc(1, sizeof(*bo))) == NULL) {
+        return NULL;
+    }
+
+    bo->ptr = block_alloc(size);
+    bo->fd = -1;
+    if (bo->ptr && (flags & OMAP_BO_CACHE_MASK) == OMAP_BO_CACHED) {
+        bo->fd = bo_udmabuf(bo->ptr, size);
+    }
+    if (bo->fd < 0) {
+        bo->fd = dup(arenaFd);  /* unique descriptor that stands for the dma-buf */
+    }
+    bo->size = size;
+    bo->flags = flags;
+
+    pthread_mutex_lock(&boLock);
+    for (i = 0; i < MQLOOP_MAX_BOS && boTable[i]; i++)
+        ;
+    if (i < MQLOOP_MAX_BOS) {
+        boTable[i] = bo;
+    }
+    pthread_mutex_unlock(&boLock);
+
+    if (bo->ptr == NULL || bo->fd < 0 || i == MQLOOP_MAX_BOS) {
+        omap_bo_del(bo);
+        return NULL;
+    }
+    return bo;
+}
+
+void omap_bo_del(struct omap_bo *bo)
+{
+    int i;
+
+    if (bo == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&boLock);
+    for (i = 0; i < MQLOOP_MAX_BOS; i++) {
+        if (boTable[i] == bo) {
+            boTable[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&boLock);
+
+    if (bo->ptr) {
+        block_free(bo->ptr);
+    }
+    if (bo->fd >= 0) {
+        close(bo->fd);
+    }
+    free(bo);
+}
+
+void *omap_bo_map(struct omap_bo *bo)
+{
+    return bo->ptr;
+}
+
+uint32_t omap_bo_size(struct omap_bo *bo)
+{
+    return bo->size;
+}
+
+int omap_bo_dmabuf(struct omap_bo *bo)
+{
+    return bo->fd;
+}
+
+int omap_bo_cpu_prep(struct omap_bo *bo, int op)
+{
+    return 0;
+}
+
+int omap_bo_cpu_fini(struct omap_bo *bo, int op)
+{
+    return 0;
+}
+
+/*
+ *  ======== MmRpc ========
+ */
+void MmRpc_Params_init(MmRpc_Params *params)
+{
+    params->reserved = 0;
+}
+
+int MmRpc_create(const char *service, const MmRpc_Params *params,
+        MmRpc_Handle *handlePtr)
+{
+    struct MmRpc_Object *obj;
+    int i, tries;
+
+    if (arena == NULL) {
+        return MmRpc_E_FAIL;
+    }
+
+    /* the remote registers its services right after attaching */
+    for (tries = 0; tries < MQLOOP_READY_SECS * 1000; tries++) {
+        for (i = 0; i < MQLOOP_MAX_SERVICES; i++) {
+            if (arena->rpc[i].used && strcmp(arena->rpc[i].name, service) == 0) {
+                break;
+            }
+        }
+        if (i < MQLOOP_MAX_SERVICES || arena->shutdown) {
+            break;
+        }
+        usleep(1000);
+    }
+    if (i == MQLOOP_MAX_SERVICES || (obj = malloc(sizeof(*obj))) == NULL) {
+        return MmRpc_E_FAIL;
+    }
+
+    obj->rpc = &arena->rpc[i];
+    *handlePtr = obj;
+    return MmRpc_S_SUCCESS;
+}
+
+int MmRpc_delete(MmRpc_Handle *handlePtr)
+{
+    free(*handlePtr);
+    *handlePtr = NULL;
+    return MmRpc_S_SUCCESS;
+}
+
+static uint64_t remote_addr(size_t addr)
+{
+    return arena->remote_base + ((char *)addr - (char *)arena);
+}
+
+int MmRpc_call(MmRpc_Handle handle, MmRpc_FxnCtx *ctx, int32_t *ret)
+{
+    struct mqloop_rpc *rpc = handle->rpc;
+    size_t saved[MmRpc_MAXPARAMS], *fields[MmRpc_MAXPARAMS], *field;
+    uint32_t i, state;
+    int status = MmRpc_S_SUCCESS;
+
+    if (ctx->num_params > MmRpc_MAXPARAMS || ctx->num_xlts > MmRpc_MAXPARAMS) {
+        return MmRpc_E_INVALIDPARAM;
+    }
+
+    lock_acquire(&rpc->lock);
+
+    rpc->fxn_id = ctx->fxn_id;
+    rpc->num_params = ctx->num_params;
+    for (i = 0; i < ctx->num_params; i++) {
+        if (ctx->params[i].type == MmRpc_ParamType_Scalar) {
+            rpc->param[i] = ctx->params[i].param.scalar.data;
+        }
+        else if (ctx->params[i].type == MmRpc_ParamType_Ptr &&
+                 bo_lookup(ctx->params[i].param.ptr.handle) &&
+                 arena_contains((void *)ctx->params[i].param.ptr.addr)) {
+            rpc->param[i] = remote_addr(ctx->params[i].param.ptr.addr);
+        }
+        else {
+            status = MmRpc_E_INVALIDPARAM;
+        }
+    }
+
+    /* embedded pointers: host address -> remote address for the call */
+    for (i = 0; i < ctx->num_xlts && status == MmRpc_S_SUCCESS; i++) {
+        MmRpc_Xlt *x = &ctx->xltAry[i];
+
+        if (x->index >= ctx->num_params ||
+            ctx->params[x->index].type != MmRpc_ParamType_Ptr) {
+            status = MmRpc_E_INVALIDPARAM;
+            break;
+        }
+        field = (size_t *)(ctx->params[x->index].param.ptr.addr + x->offset);
+        if (!bo_lookup(x->handle) || !arena_contains(field) ||
+            !arena_contains((void *)*field)) {
+            status = MmRpc_E_INVALIDPARAM;
+            break;
+        }
+        fields[i] = field;
+        saved[i] = *field;
+        *field = (size_t)remote_addr(*field);
+    }
+
+    if (status == MmRpc_S_SUCCESS) {
+        __atomic_store_n(&rpc->state, MQLOOP_RPC_REQUEST, __ATOMIC_RELEASE);
+        futex_wake(&rpc->state, INT_MAX);
+        while ((state = __atomic_load_n(&rpc->state, __ATOMIC_ACQUIRE)) != MQLOOP_RPC_DONE &&
+               !arena->shutdown) {
+            futex_wait(&rpc->state, state, NULL);
+        }
+        *ret = rpc->result;
+        if (state != MQLOOP_RPC_DONE) {
+            status = MmRpc_E_SYS;
+        }
+        rpc->state = MQLOOP_RPC_IDLE;
+    }
+
+    /* put the host addresses back */
+    while (i-- > 0) {
+        *fields[i] = saved[i];
+    }
+
+    lock_release(&rpc->lock);
+    return status;
+}
+
+int MmRpc_use(MmRpc_Handle handle, MmRpc_BufType type, int num,
+        MmRpc_BufDesc *desc)
+{
+    int i;
+
+    for (i = 0; i < num; i++) {
+        if (type == MmRpc_BufType_Handle && bo_lookup(desc[i].handle) == NULL) {
+            return MmRpc_E_INVALIDPARAM;
+        }
+    }
+    return MmRpc_S_SUCCESS;
+}
+
+int MmRpc_release(MmRpc_Handle handle, MmRpc_BufType type, int num,
+        MmRpc_BufDesc *desc)
+{
+    return MmRpc_S_SUCCESS;
+}
+
+int mqloop_rpc_serve(const char *service, const mqloop_rpc_fxn *fxns, int count)
+{
+    struct mqloop_rpc *rpc = NULL;
+    uint32_t state, index;
+    int i;
+
+    lock_acquire(&arena->table_lock);
+    for (i = 0; i < MQLOOP_MAX_SERVICES; i++) {
+        if (!arena->rpc[i].used) {
+            rpc = &arena->rpc[i];
+            memset(rpc, 0, sizeof(*rpc));
+            snprintf(rpc->name, sizeof(rpc->name), "%s", service);
+            rpc->used = 1;
+            break;
+        }
+    }
+    lock_release(&arena->table_lock);
+
+    if (rpc == NULL) {
+        return -1;
+    }
+
+    while (!arena->shutdown) {
+        state = __atomic_load_n(&rpc->state, __ATOMIC_ACQUIRE);
+        if (state != MQLOOP_RPC_REQUEST) {
+            futex_wait(&rpc->state, state, NULL);
+            continue;
+        }
+
+        index = rpc->fxn_id & 0x7FFFFFFF;
+        rpc->result = index < (uint32_t)count ?
+                      fxns[index](rpc->num_params, rpc->param) : -1;
+        __atomic_store_n(&rpc->state, MQLOOP_RPC_DONE, __ATOMIC_RELEASE);
+        futex_wake(&rpc->state, INT_MAX);
+    }
+
+    rpc->used = 0;
+    return 0;
+}
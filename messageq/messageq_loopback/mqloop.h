@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   mqloop.h
+ *
+ *  @brief  Shared arena layout of the loopback IPC shim and the calls the
+ *          remote companion process uses on top of the MessageQ API
+ *
+ *  Everything that crosses the process boundary lives in one memfd arena
+ *  and refers to other arena objects by 32-bit offset, so each process may
+ *  map it anywhere. Device addresses handed to the "remote core" are
+ *  MQLOOP_DEVADDR_BASE + offset, which fits the 32-bit address fields the
+ *  benchmark messages carry.
+ *  ============================================================================
+ */
+#ifndef MQLOOP_H
+#define MQLOOP_H
+
+#include <stdint.h>
+
+#include <ti/ipc/Std.h>
+#include <ti/ipc/mm/MmRpc.h>
+
+#define MQLOOP_MAGIC            0x4d514c50
+#define MQLOOP_MAX_QUEUES       4096
+#define MQLOOP_MAX_SERVICES     8
+#define MQLOOP_NAME_LEN         48
+#define MQLOOP_NUM_CLASSES      32
+#define MQLOOP_BLOCK_HDR        64
+#define MQLOOP_DEVADDR_BASE     0x80000000u
+#define MQLOOP_DEFAULT_SIZE_MB  256
+
+/* Processor the remote companion runs as, matches COREPROC1 in the app */
+#define MQLOOP_REMOTE_PROCID    1
+
+enum {
+    MQLOOP_RPC_IDLE = 0,
+    MQLOOP_RPC_REQUEST,
+    MQLOOP_RPC_DONE
+};
+
+struct mqloop_queue {
+    char name[MQLOOP_NAME_LEN];
+    uint32_t used;
+    uint32_t procId;
+    uint32_t lock;
+    uint32_t head;              /* first message, 0 = empty */
+    uint32_t tail;
+    uint32_t count;
+    uint32_t seq;               /* futex word, bumped on every put */
+    uint32_t waiters;
+    uint32_t unblocked;
+};
+
+struct mqloop_rpc {
+    char name[MQLOOP_NAME_LEN];
+    uint32_t used;
+    uint32_t lock;              /* one call in flight per service */
+    uint32_t state;             /* futex word, MQLOOP_RPC_* */
+    uint32_t fxn_id;
+    uint32_t num_params;
+    int32_t result;
+    uint64_t param[MmRpc_MAXPARAMS];    /* scalar or remote pointer */
+};
+
+struct mqloop_arena {
+    uint32_t magic;
+    uint32_t shutdown;
+    uint64_t size;
+    uint64_t remote_base;       /* where the remote mapped the arena */
+    uint32_t remote_ready;      /* futex word */
+    uint32_t heap_lock;
+    uint64_t brk;
+    uint32_t free_list[MQLOOP_NUM_CLASSES];
+    uint32_t table_lock;        /* queue and service tables */
+    struct mqloop_queue queue[MQLOOP_MAX_QUEUES];
+    struct mqloop_rpc rpc[MQLOOP_MAX_SERVICES];
+};
+
+typedef int32_t (*mqloop_rpc_fxn)(uint32_t num_params, uint64_t *params);
+
+/* Remote side: map the arena inherited as fd and act as processor procId */
+int mqloop_attach(int fd, UInt16 procId);
+void mqloop_detach(void);
+
+/* Serve MmRpc calls for service until Ipc_stop() on the host side */
+int mqloop_rpc_serve(const char *service, const mqloop_rpc_fxn *fxns, int count);
+
+int mqloop_shutdown(void);
+
+uint32_t mqloop_devaddr(const void *ptr);
+void *mqloop_ptr(uint32_t devaddr);
+
+#endif
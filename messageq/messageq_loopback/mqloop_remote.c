@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2015, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* =============================================================================
+ *  @file   mqloop_remote.c
+ *
+ *  @brief  Remote side of MessageQZCpy for the loopback shim
+ *
+ *  Stands in for messageq_zerocpy.xem4: runs the same remote side logic,
+ *  mq_remote.c of the BIOS package, over POSIX threads and clocks, while a
+ *  second thread serves the rpc_example MmRpc service. Started by
+ *  Ipc_start() with the arena descriptor as its only argument.
+ *  ============================================================================
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mqloop.h"
+#include "mq_remote.h"
+
+#define SERVICE_NAME       "rpc_example"
+
+struct MqOs_Task {
+    pthread_t thread;
+    MqOs_TaskFxn fxn;
+    Void *arg;
+};
+
+static long long monotonic_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void *taskStub(void *arg)
+{
+    struct MqOs_Task *task = arg;
+
+    task->fxn(task->arg);
+    return NULL;
+}
+
+MqOs_TaskHandle MqOs_taskCreate(MqOs_TaskFxn fxn, Void *arg)
+{
+    struct MqOs_Task *task = malloc(sizeof(*task));
+
+    if (task == NULL) {
+        return NULL;
+    }
+    task->fxn = fxn;
+    task->arg = arg;
+    if (pthread_create(&task->thread, NULL, taskStub, task) != 0) {
+        free(task);
+        return NULL;
+    }
+    return task;
+}
+
+Void MqOs_taskJoin(MqOs_TaskHandle task)
+{
+    pthread_join(task->thread, NULL);
+    free(task);
+}
+
+Void MqOs_sleepUs(UInt32 usecs)
+{
+    usleep(usecs);
+}
+
+UInt32 MqOs_timeUs(Void)
+{
+    return (UInt32)(monotonic_ns() / 1000);
+}
+
+/* No 32K counter here: CLOCK_MONOTONIC in ns, like the host */
+UInt32 MqOs_syncClock(Void)
+{
+    return (UInt32)monotonic_ns();
+}
+
+UInt32 MqOs_syncClockHz(Void)
+{
+    return 1000000000;
+}
+
+Void *MqOs_alloc(SizeT size)
+{
+    return calloc(1, size);
+}
+
+Void MqOs_free(Void *ptr, SizeT size)
+{
+    free(ptr);
+}
+
+Void *MqOs_ptr(UInt32 devaddr)
+{
+    return mqloop_ptr(devaddr);
+}
+
+UInt32 MqOs_devaddr(Void *ptr)
+{
+    return mqloop_devaddr(ptr);
+}
+
+/* The arena is coherent, order the accesses only */
+Void MqOs_cacheInv(Void *ptr, SizeT size)
+{
+    __sync_synchronize();
+}
+
+Void MqOs_cacheWb(Void *ptr, SizeT size)
+{
+    __sync_synchronize();
+}
+
+Void MqOs_abort(const Char *msg)
+{
+    if (!mqloop_shutdown()) {
+        fprintf(stderr, "mqloop_remote: %s", msg);
+    }
+    exit(1);
+}
+
+Void MqOs_sessionStart(Void)
+{
+}
+
+Void MqOs_sessionEnd(Void)
+{
+}
+
+static int32_t rpc_compute(uint32_t num_params, uint64_t *params)
+{
+    if (num_params < 1) {
+        return -1;
+    }
+    return MxServer_compute((MxServer_Compute *)(uintptr_t)params[0]);
+}
+
+static int32_t rpc_bench(uint32_t num_params, uint64_t *params)
+{
+    uint32_t i, scalars = 0;
+
+    if (num_params < 1) {
+        return -1;
+    }
+    for (i = 1; i < num_params; i++) {
+        scalars += (uint32_t)params[i];
+    }
+    return MxServer_bench((MxServer_Bench *)(uintptr_t)params[0], scalars);
+}
+
+/* as on the IPU, MxServer_bench<P> at index P */
+static const mqloop_rpc_fxn rpcFxns[] = {
+    rpc_compute, rpc_bench, rpc_bench, rpc_bench, rpc_bench,
+    rpc_bench, rpc_bench, rpc_bench, rpc_bench
+};
+
+static void *rpcThread(void *arg)
+{
+    char name[32];
+
+    snprintf(name, sizeof(name), "%s_%d", SERVICE_NAME, MultiProc_self());
+    mqloop_rpc_serve(name, rpcFxns, sizeof(rpcFxns) / sizeof(rpcFxns[0]));
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t rpcThr;
+    int fd;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <arena fd | /proc/<pid>/fd/<n>>\n", argv[0]);
+        return 1;
+    }
+    fd = strchr(argv[1], '/') ? open(argv[1], O_RDWR) : atoi(argv[1]);
+    if (fd < 0 || mqloop_attach(fd, MQLOOP_REMOTE_PROCID) < 0) {
+        return 1;
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    MqRemote_init();
+    pthread_create(&rpcThr, NULL, rpcThread, NULL);
+
+    while (!mqloop_shutdown() && MqRemote_session() == 0) {
+    }
+
+    mqloop_detach();
+    return 0;
+}